@@ -39,6 +39,7 @@
 #include <sys/io.h>
 
 #include <cpu/common.h>
+#include <cpu/smp.h>
 #include <superio/superio.h>
 
 #include <drivers/device.h>
@@ -57,15 +58,25 @@
 #include <romcall/romcall.h>
 #include <stacks/ctx.h>
 
+#include <time/tick.h>
+#include <time/timestamp.h>
+
 heap_start *heap = (heap_start *)0x8000;
 
 device *memory_device = 0;
 device *cmos_dev = 0;
 device *uart_dev = 0;
-console_device default_console_device = {0};
+device *debugcon_dev = 0;
+device *memring_dev = 0;
+device *fbcon_dev = 0;
+device *vgatext_dev = 0;
+console_router console = {0};
 device *keyboard_controller_device = 0;
 device *programmable_interrupt_controller = 0;
 device *programmable_interrupt_timer = 0;
+device *local_apic_dev = 0;
+// Filled in once by PCI post step, read-only after that. APs only see
+// it through work queued later, queue lock orders the stores for them.
 device **pci_device_array = 0;
 ata_ide **ata_ide_array = 0;
 
@@ -74,6 +85,9 @@ ata_ide **ata_ide_array = 0;
  * This function should never return.
  */
  __attribute__ ((noreturn)) void c_main(void) {
+    // Heap and console locks want to know which cpu they're on
+    smp_boot_cpu_init();
+    timestamp_init();
     superio_init();
 
     heap_init((uint64_t)heap, (0x70000 - 0x8000));
@@ -82,12 +96,10 @@ ata_ide **ata_ide_array = 0;
 
     blog("Early chipset initialisation done\n");
     blog("No payloads to execute, hang\n");
-
-    pic_unmask_irq(0);
-    asm volatile("sti");
+    smp_park();
 
     for (;;) { 
-        halt();
+        idle();
     }
 }
 
@@ -32,157 +32,667 @@
 
 #include <stdbool.h>
 #include <stdarg.h>
-
-#include <sys/io.h>
-#include <superio/superio.h>
+#include <stdint.h>
 
 #include <drivers/device.h>
-#include <drivers/serial/serial.h>
 
 #include <console/console.h>
+#include <console/binlog.h>
 
+#include <stdlib.h>
 #include <string.h>
-#include <itoa.h>
 
-extern console_device default_console_device;
+#include <cpu/common.h>
+#include <cpu/percpu.h>
+#include <sys/spinlock.h>
+
+#include <time/clock.h>
+#include <time/timer.h>
+
+// Set while formatting text for sinks that can't take binary log
+// records, binary sinks got the same message already.
+static bool console_text_only = false;
+
+// Console lock is recursive, so that blogf_text_args() can call blogf.
+// Interrupts stay off while it's held, sink line buffers aren't safe
+// against a handler logging in the middle of a write on the same cpu.
+static spinlock console_lock = SPINLOCK_INIT;
+static volatile uint32_t console_owner = UINT32_MAX;
+static uint32_t console_depth = 0;
+static bool console_int_enabled = false;
 
-/* Write log message over default output device
+static timer console_flush_timer;
+
+/* Take console lock, unless we hold it already. Interrupts are off
+ * until the matching console_leave().
+ */
+static void console_enter(void) {
+    uint32_t self = this_cpu()->index;
+    bool int_enabled = interrupts_enabled();
+    cli();
+    if (console_owner != self) {
+        spin_lock(&console_lock);
+        console_owner = self;
+        console_int_enabled = int_enabled;
+    }
+    console_depth++;
+}
+
+/* Take console lock only if nobody, us included, holds it
  *
- * @param console_device *dev -- device to use for output
- * @param char *msg -- message to print
+ * @return bool true if we got it
+ */
+static bool console_try_enter(void) {
+    bool int_enabled = interrupts_enabled();
+    cli();
+    bool ret = spin_trylock(&console_lock);
+    if (ret) {
+        console_owner = this_cpu()->index;
+        console_depth = 1;
+        console_int_enabled = int_enabled;
+    } else if (int_enabled) {
+        sti();
+    }
+    return ret;
+}
+
+/* Drop one level of console lock, outermost one releases it and puts
+ * interrupt flag back as console_enter() found it
+ */
+static void console_leave(void) {
+    if (--console_depth == 0) {
+        bool int_enabled = console_int_enabled;
+        console_owner = UINT32_MAX;
+        spin_unlock(&console_lock);
+        if (int_enabled) {
+            sti();
+        }
+    }
+}
+
+static void console_flush_timer_cb(void *arg);
+
+/* Arm flush timer, if it isn't already, for a partial line that just
+ * got buffered. Timer wheel belongs to boot cpu, partial lines from
+ * other cpus wait for the next newline or write from boot cpu.
+ */
+static void console_arm_flush_timer(void) {
+    if ((console_flush_timer.pending == false) && (this_cpu()->index == 0)) {
+        timer_add(&console_flush_timer, (now_ns() + (CONSOLE_FLUSH_INTERVAL_MS * 1000000ULL)),
+                console_flush_timer_cb, NULL);
+    }
+}
+
+/* Write out everything sitting in sink line buffer
  *
+ * @param console_sink *sink -- sink to flush
  */
-void blog(char *msg) {
-    if (default_console_device.enabled == false) {
+static void console_sink_flush(console_sink *sink) {
+    if (sink->buf_used) {
+        sink->write(sink->dev, sink->buf, sink->buf_used);
+        sink->buf_used = 0;
+    }
+}
+
+/* Pass data to a single sink, buffered sinks get a write only
+ * once we've got full line or their buffer is full.
+ *
+ * @param console_sink *sink -- sink to write to
+ * @param const char *msg    -- data to write
+ * @param size_t len         -- amount of bytes to write
+ */
+static void console_sink_write(console_sink *sink, const char *msg, size_t len) {
+    if (sink->buf == NULL) {
+        sink->write(sink->dev, msg, len);
+        return;
+    }
+    for (size_t i = 0; i < len; i++) {
+        sink->buf[sink->buf_used++] = msg[i];
+        if ((msg[i] == '\n') || (sink->buf_used >= CONSOLE_SINK_BUF_SIZE)) {
+            console_sink_flush(sink);
+        }
+    }
+    if (sink->buf_used) {
+        console_arm_flush_timer();
+    }
+}
+
+/* Pass data to every sink that wants messages of given level
+ *
+ * @param enum LOG_LEVEL level -- message level
+ * @param const char *msg      -- data to write
+ * @param size_t len           -- amount of bytes to write
+ */
+static void console_write(enum LOG_LEVEL level, const char *msg, size_t len) {
+    for (uint8_t i = 0; i < console.count; i++) {
+        console_sink *sink = &console.sink[i];
+        if (console_text_only && sink->binary) {
+            continue;
+        }
+        if (sink->enabled && (level <= sink->level)) {
+            console_sink_write(sink, msg, len);
+        }
+    }
+}
+
+/* Write raw data to binary sinks that want given level
+ *
+ * @param enum LOG_LEVEL level -- record level
+ * @param const char *data     -- record to write
+ * @param size_t len           -- size of record
+ */
+void console_write_binary(enum LOG_LEVEL level, const char *data, size_t len) {
+    console_enter();
+    for (uint8_t i = 0; i < console.count; i++) {
+        console_sink *sink = &console.sink[i];
+        if (sink->enabled && sink->binary && (level <= sink->level)) {
+            console_sink_write(sink, data, len);
+        }
+    }
+    console_leave();
+}
+
+/* Check if any text or binary sink wants messages of given level
+ *
+ * @param enum LOG_LEVEL level -- message level
+ * @param bool binary          -- are we asking about binary sinks
+ * @return bool true if there's someone to write to
+ */
+bool console_wants(enum LOG_LEVEL level, bool binary) {
+    for (uint8_t i = 0; i < console.count; i++) {
+        console_sink *sink = &console.sink[i];
+        if (sink->enabled && (sink->binary == binary) && (level <= sink->level)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Recalculate most verbose level any of our sinks wants, so that
+ * we can skip formatting messages nobody is going to see.
+ */
+static void console_update_max_level(void) {
+    console.max_level = log_error;
+    for (uint8_t i = 0; i < console.count; i++) {
+        if (console.sink[i].enabled && (console.sink[i].level > console.max_level)) {
+            console.max_level = console.sink[i].level;
+        }
+    }
+}
+
+/* Add a new output device for console messages. Buffered sinks
+ * collect output until end of line so that each line gets written 
+ * with one call, unbuffered sinks get everything as it comes.
+ *
+ * @param device *dev              -- initialised output device
+ * @param console_write_func write -- function to write to it with
+ * @param char *name               -- name of this sink
+ * @param enum LOG_LEVEL level     -- most verbose level to send to this sink
+ * @param uint8_t flags            -- CONSOLE_SINK_* flags
+ * @return pointer to console_sink or NULL if we're out of sinks
+ */
+console_sink *console_add_sink(device *dev, console_write_func write, char *name, 
+        enum LOG_LEVEL level, uint8_t flags) {
+    console_enter();
+    if (console.count == CONSOLE_MAX_SINKS) {
+        console_leave();
+        return NULL;
+    }
+    console_sink *sink = &console.sink[console.count];
+    sink->dev = dev;
+    sink->write = write;
+    sink->name = name;
+    sink->level = level;
+    sink->buf = NULL;
+    sink->buf_used = 0;
+#ifdef CONFIG_BINARY_LOG
+    sink->binary = ((flags & CONSOLE_SINK_BINARY) != 0);
+#else
+    sink->binary = false;
+#endif
+    if (flags & CONSOLE_SINK_BUFFERED) {
+        // Unbuffered is slower, but works just as well 
+        sink->buf = malloc(CONSOLE_SINK_BUF_SIZE);
+    }
+    sink->enabled = true;
+    console.count++;
+    console_update_max_level();
+    console_leave();
+    return sink;
+}
+
+/* Change level of an existing console sink
+ *
+ * @param console_sink *sink   -- sink to adjust
+ * @param enum LOG_LEVEL level -- new level
+ */
+void console_set_level(console_sink *sink, enum LOG_LEVEL level) {
+    console_enter();
+    sink->level = level;
+    console_update_max_level();
+    console_leave();
+}
+
+/* Stop sending console output to a device, whatever is still 
+ * buffered for it gets written out first.
+ *
+ * @param device *dev -- output device to detach
+ */
+void console_detach_device(device *dev) {
+    console_enter();
+    for (uint8_t i = 0; i < console.count; i++) {
+        console_sink *sink = &console.sink[i];
+        if (sink->enabled && (sink->dev == dev)) {
+            if (sink->buf) {
+                console_sink_flush(sink);
+            }
+            sink->enabled = false;
+        }
+    }
+    console_update_max_level();
+    console_leave();
+}
+
+/* Write out everything still sitting in sink line buffers
+ */
+void console_flush(void) {
+    console_enter();
+    for (uint8_t i = 0; i < console.count; i++) {
+        if (console.sink[i].enabled && console.sink[i].buf) {
+            console_sink_flush(&console.sink[i]);
+        }
+    }
+    console_leave();
+}
+
+/* Timer callback, write out partial lines nobody has finished in a
+ * while. Keeps off sink buffers if someone, maybe the code we 
+ * interrupted, is working on them, and tries again later then. Once 
+ * buffers are empty timer stays off until next partial line.
+ *
+ * @param void *arg -- unused
+ */
+static void console_flush_timer_cb(void *arg __attribute__((unused))) {
+    if (console_try_enter()) {
+        console_flush();
+        console_leave();
         return;
     }
-    serial_uart_device *udev = default_console_device.dev->device_data;
-    default_console_device.tx_func(udev->base_port, msg, strlen(msg));
+    console_arm_flush_timer();
 }
 
-/* Print a sinlge byte over default output device
+/* Start flushing partial lines out of sink line buffers after a 
+ * while, so that output without a newline doesn't sit in them forever.
+ * Timer is only armed while some sink holds a partial line.
  *
- * @param char c -- character to write
+ * @return bool true if timer was armed
  */
-static inline void bputchar(char c) {
-    if (default_console_device.enabled == false) {
+bool console_start_flush_timer(void) {
+    bool partial = false;
+    console_enter();
+    for (uint8_t i = 0; i < console.count; i++) {
+        if (console.sink[i].enabled && console.sink[i].buf && console.sink[i].buf_used) {
+            partial = true;
+        }
+    }
+    if (partial) {
+        console_arm_flush_timer();
+    }
+    console_leave();
+    return console_flush_timer.pending;
+}
+
+/* Write log message of given level to all sinks that want it
+ *
+ * @param enum LOG_LEVEL level -- message level
+ * @param char *msg            -- message to print
+ */
+void blog_lvl(enum LOG_LEVEL level, char *msg) {
+    if (level > console.max_level) {
         return;
     }
+    console_enter();
+    console_write(level, msg, strlen(msg));
+    console_leave();
+}
 
-    serial_uart_device *udev = default_console_device.dev->device_data;
-    default_console_device.tx_func(udev->base_port, &c, 1);
+/* Write log message with log_info level
+ *
+ * @param char *msg -- message to print
+ *
+ */
+void blog(char *msg) {
+    blog_lvl(log_info, msg);
 }
 
-/* Print single integer over default output device
+// Format specifier flags
+#define BLOGF_LEFT      0x01    // '-', pad on the right
+#define BLOGF_ZERO      0x02    // '0', pad numbers with zeroes
+#define BLOGF_SIGNED    0x04    // number is signed
+#define BLOGF_UPPER     0x08    // upper case hex digits
+#define BLOGF_PREFIX    0x10    // prefix number with 0x
+
+// Largest field we pad to, anything wider is clamped
+#define BLOGF_MAX_WIDTH 64
+
+/* Write given amount of spaces for field padding
  *
- * @param int leading_zeros -- Amount of leading 0's to print
- * @param int d -- integer to print
- * @param int base -- base number
+ * @param enum LOG_LEVEL level -- message level
+ * @param int count            -- amount of padding to write
  */
-static inline void bputint(int leading_zeros, int d, int base) {
-    char tmp[33];
-    memset(tmp, 0, 33);
+static void blogf_pad(enum LOG_LEVEL level, int count) {
+    static const char pad[16] = "                ";
+    while (count > 0) {
+        int chunk = (count > (int)sizeof(pad)) ? (int)sizeof(pad) : count;
+        console_write(level, pad, chunk);
+        count -= chunk;
+    }
+}
 
-    if (base == 16) {
-        itoah(d, tmp);
-    } else {
-        itoa(d, tmp);
+/* Write a string padded to given field width
+ *
+ * @param enum LOG_LEVEL level -- message level
+ * @param const char *s        -- string to write
+ * @param size_t len           -- length of string
+ * @param int width            -- field width
+ * @param uint8_t flags        -- BLOGF_* flags
+ * @return int amount of characters written
+ */
+static int blogf_field(enum LOG_LEVEL level, const char *s, size_t len, int width, uint8_t flags) {
+    int pad = width - (int)len;
+    if ((pad > 0) && !(flags & BLOGF_LEFT)) {
+        blogf_pad(level, pad);
     }
+    console_write(level, s, len);
+    if ((pad > 0) && (flags & BLOGF_LEFT)) {
+        blogf_pad(level, pad);
+    }
+    return (pad > 0) ? (width) : (int)len;
+}
 
-    char *start = tmp;
-    for (int i = 0; i < 32; i++) {
-        if (*start != 0x30)
-            break;
-        start++;
+/* Format a number into a single span and write it out
+ *
+ * @param enum LOG_LEVEL level -- message level
+ * @param uint64_t value       -- number to write, two's complement if signed
+ * @param unsigned int base    -- 10 or 16
+ * @param int width            -- field width
+ * @param uint8_t flags        -- BLOGF_* flags
+ * @return int amount of characters written
+ */
+static int blogf_number(enum LOG_LEVEL level, uint64_t value, unsigned int base, int width, uint8_t flags) {
+    const char *digits = (flags & BLOGF_UPPER) ? "0123456789ABCDEF" : "0123456789abcdef";
+    char buf[BLOGF_MAX_WIDTH + 24];
+    char *end = &buf[sizeof(buf)];
+    char *p = end;
+    bool negative = false;
+
+    if ((flags & BLOGF_SIGNED) && ((int64_t)value < 0)) {
+        negative = true;
+        value = -value;
     }
-    if (strlen(start) == 0) {
-        start--;
+    do {
+        *--p = digits[value % base];
+        value /= base;
+    } while (value);
+
+    if (width > BLOGF_MAX_WIDTH) {
+        width = BLOGF_MAX_WIDTH;
     }
-    if (leading_zeros) {
-        if (strlen(start) < (unsigned long)leading_zeros) {
-            int count = leading_zeros - strlen(start);
-            start = (char *)((uint64_t)start - count);
+    int prefix = (negative ? 1 : 0) + ((flags & BLOGF_PREFIX) ? 2 : 0);
+    if ((flags & BLOGF_ZERO) && !(flags & BLOGF_LEFT)) {
+        while ((end - p) < (width - prefix)) {
+            *--p = '0';
         }
     }
-    blog(start);
+    if (flags & BLOGF_PREFIX) {
+        *--p = 'x';
+        *--p = '0';
+    }
+    if (negative) {
+        *--p = '-';
+    }
+    return blogf_field(level, p, (size_t)(end - p), width, flags);
+}
+
+/* Where formatted messages take their arguments from, va_list or
+ * arguments already collected for a binary log record.
+ *
+ * @member va_list ap           -- arguments, if args is NULL
+ * @member const blog_arg *args -- record arguments
+ * @member uint8_t argc         -- amount of record arguments
+ * @member uint8_t next         -- next record argument to take
+ */
+typedef struct {
+    va_list ap;
+    const blog_arg *args;
+    uint8_t argc;
+    uint8_t next;
+} blogf_source;
+
+static uint64_t blogf_record_arg(blogf_source *src) {
+    return (src->next < src->argc) ? src->args[src->next++].value : 0;
 }
 
-/* log messages, now with format string from panic() and co! 
+#define BLOGF_ARG(src, type) ((src)->args ? (type)blogf_record_arg(src) : va_arg((src)->ap, type))
+
+/* log messages of given level with format string, with console lock
+ * held.
+ *
+ * Format string is walked once, literal text between conversions
+ * goes out as a single write. Supported conversions are
+ * %[-][0][width|*][hh|h|l|ll|z](d|i|u|x|X|p|c|s|%)
  *
+ * @param enum LOG_LEVEL level        -- message level
  * @param const char *restrict format
- * @param va_list ap :3
+ * @param blogf_source *src           -- arguments :3
  * @return int bytes written
  */
-int vfblogf(const char *restrict format, va_list ap) {
-    if (default_console_device.enabled == false) {
-        return 0;
-    }
-
+static int vfblogf_locked(enum LOG_LEVEL level, const char *restrict format, blogf_source *src) {
     int written = 0;
-    int d;
-    char c;
-    char *s;
-    bool escaped = false;
 
-    do {
-        if (escaped) {
-            bputchar(*format);
-            escaped = false;
-        } else {
-            if (*format == '\\') {
-                escaped = true;
-            } else if (*format == '%') {
+    while (*format) {
+        const char *span = format;
+        while (*format && (*format != '%')) {
+            format++;
+        }
+        if (format != span) {
+            console_write(level, span, (size_t)(format - span));
+            written += (int)(format - span);
+        }
+        if (*format == 0) {
+            break;
+        }
+        format++;
+
+        uint8_t flags = 0;
+        for (;; format++) {
+            if (*format == '-') {
+                flags |= BLOGF_LEFT;
+            } else if (*format == '0') {
+                flags |= BLOGF_ZERO;
+            } else {
+                break;
+            }
+        }
+        int width = 0;
+        if (*format == '*') {
+            width = BLOGF_ARG(src, int);
+            if (width < 0) {
+                flags |= BLOGF_LEFT;
+                width = -width;
+            }
+            format++;
+        }
+        while ((*format >= '0') && (*format <= '9')) {
+            width = (width * 10) + (*format - '0');
+            format++;
+        }
+        // 0 = int, 1 = long, -1 = short, -2 = char
+        int length = 0;
+        if (*format == 'l') {
+            length = 1;
+            format++;
+            if (*format == 'l') {
                 format++;
-                int lc = 0;
-                if (*format == '0') {
-                    format++;
-                    while (*format <= 0x39) {
-                        if (*(format + 1) <= 0x39) {
-                            lc += 10 * ((int)(*format & 0x0F));
-                        } else {
-                            lc += (int)(*format & 0x0F);
-                        }
-                        format++;
-                    }
-                }
-                switch (*format) {
-                case 's':
-                    s = va_arg(ap, char *);
-                    blog(s);
-                    written += strlen(s);
-                    break;
-                case 'x':
-                    d = va_arg(ap, int);
-                    bputint(lc, d, 16);
-                    written += sizeof(int);
-                    written += lc;
-                    break;
-                case 'd':
-                    d = va_arg(ap, int);
-                    bputint(lc, d, 10);
-                    written += sizeof(int);
-                    written += lc;
-                    break;
-                case 'c':
-                    c = (char) va_arg(ap, int);
-                    bputchar(c);
-                    written++;
-                    break;
-                default:
-                    format--;
-                    bputchar(*format);
-                    written++;
+            }
+        } else if (*format == 'z') {
+            length = 1;
+            format++;
+        } else if (*format == 'h') {
+            length = -1;
+            format++;
+            if (*format == 'h') {
+                length = -2;
+                format++;
+            }
+        }
+
+        uint64_t value;
+        char c;
+        const char *s;
+        switch (*format) {
+        case 'd':
+        case 'i':
+            if (length > 0) {
+                value = (uint64_t)BLOGF_ARG(src, int64_t);
+            } else {
+                int v = BLOGF_ARG(src, int);
+                if (length == -1) {
+                    v = (short)v;
+                } else if (length == -2) {
+                    v = (signed char)v;
                 }
+                value = (uint64_t)(int64_t)v;
+            }
+            written += blogf_number(level, value, 10, width, (flags | BLOGF_SIGNED));
+            break;
+        case 'u':
+        case 'x':
+        case 'X':
+            if (length > 0) {
+                value = BLOGF_ARG(src, uint64_t);
             } else {
-                bputchar(*format);
-                written++;
+                value = BLOGF_ARG(src, unsigned int);
+                if (length == -1) {
+                    value &= 0xFFFF;
+                } else if (length == -2) {
+                    value &= 0xFF;
+                }
+            }
+            if (*format == 'X') {
+                flags |= BLOGF_UPPER;
             }
+            written += blogf_number(level, value, ((*format == 'u') ? 10 : 16), width, flags);
+            break;
+        case 'p':
+            value = (uint64_t)BLOGF_ARG(src, void *);
+            written += blogf_number(level, value, 16, 18, (flags | BLOGF_ZERO | BLOGF_PREFIX));
+            break;
+        case 'c':
+            c = (char)BLOGF_ARG(src, int);
+            written += blogf_field(level, &c, 1, width, flags);
+            break;
+        case 's':
+            s = BLOGF_ARG(src, const char *);
+            if (!s) {
+                s = "(null)";
+            }
+            written += blogf_field(level, s, strlen(s), width, flags);
+            break;
+        case '%':
+            console_write(level, "%", 1);
+            written++;
+            break;
+        case 0:
+            // Format ends in the middle of conversion, nothing to print
+            return written;
+        default:
+            // Unknown conversion, print it as is so that it's visible
+            console_write(level, "%", 1);
+            console_write(level, format, 1);
+            written += 2;
+            break;
         }
-    } while (*format++);
+        format++;
+    }
+    return written;
+}
+
+/* log messages of given level with format string and va_list, whole
+ * message goes out in one piece even if other cpus log too.
+ *
+ * @param enum LOG_LEVEL level        -- message level
+ * @param const char *restrict format
+ * @param va_list ap :3
+ * @return int bytes written
+ */
+int vfblogf_lvl(enum LOG_LEVEL level, const char *restrict format, va_list ap) {
+    if (level > console.max_level) {
+        return 0;
+    }
+    blogf_source src = { .args = NULL };
+    va_copy(src.ap, ap);
+    console_enter();
+    int written = vfblogf_locked(level, format, &src);
+    console_leave();
+    va_end(src.ap);
+    return written;
+}
+
+/* log messages with log_info level, now with format string from panic() and co! 
+ *
+ * @param const char *restrict format
+ * @param va_list ap :3
+ * @return int bytes written
+ */
+int vfblogf(const char *restrict format, va_list ap) {
+    return vfblogf_lvl(log_info, format, ap);
+}
+
+/* log messages of given level, now with format string!
+ *
+ * @param enum LOG_LEVEL level        -- message level
+ * @param const char *restrict format
+ * @param ... :3
+ * @return int bytes written
+ */
+int blogf_lvl(enum LOG_LEVEL level, const char *restrict format, ...) {
+    va_list ap;
+    int written = 0;
+
+    va_start(ap, format);
+    written = vfblogf_lvl(level, format, ap);
+    va_end(ap);
+    return written;
+}
+
+/* log messages of given level to text sinks only, with format string
+ * and arguments of a binary log record. Used by binary logging for 
+ * sinks that can't take binary records.
+ *
+ * @param enum LOG_LEVEL level        -- message level
+ * @param const char *restrict format
+ * @param const blog_arg *args        -- arguments
+ * @param uint8_t argc                -- amount of arguments
+ * @return int bytes written
+ */
+int blogf_text_args(enum LOG_LEVEL level, const char *restrict format, const blog_arg *args, 
+        uint8_t argc) {
+    blogf_source src = { .args = args, .argc = argc, .next = 0 };
+    int written = 0;
+
+    if (level > console.max_level) {
+        return 0;
+    }
+    console_enter();
+    console_text_only = true;
+    written = vfblogf_locked(level, format, &src);
+    console_text_only = false;
+    console_leave();
     return written;
 }
 
-/* log messages, now with format string!
+/* log messages with log_info level, now with format string!
  *
  * @param const char *restrict format
  * @param ... :3
@@ -193,7 +703,7 @@ int blogf(const char *restrict format, ...) {
     int written = 0;
 
     va_start(ap, format);
-    written = vfblogf(format, ap);
+    written = vfblogf_lvl(log_info, format, ap);
     va_end(ap);
     return written;
 }
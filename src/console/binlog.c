@@ -0,0 +1,102 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2026, k4m1 <me@k4m1.net>
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+ 
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+ 
+ 3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <console/console.h>
+#include <console/binlog.h>
+
+/* Append unsigned LEB128 encoded value to record
+ *
+ * @param char *rec      -- record buffer
+ * @param size_t off     -- where to write to
+ * @param uint64_t value -- value to encode
+ * @return size_t offset after encoded value
+ */
+static size_t blog_bin_put_uleb(char *rec, size_t off, uint64_t value) {
+    do {
+        uint8_t byte = (value & 0x7F);
+        value >>= 7;
+        if (value) {
+            byte |= 0x80;
+        }
+        rec[off++] = (char)byte;
+    } while (value);
+    return off;
+}
+
+/* Emit a binary log record to binary sinks
+ *
+ * @param enum LOG_LEVEL level -- message level
+ * @param const char *fmt      -- format string in .blog_fmt section
+ * @param const blog_arg *args -- arguments
+ * @param uint8_t argc         -- amount of arguments
+ */
+void blog_bin_emit(enum LOG_LEVEL level, const char *fmt, const blog_arg *args, uint8_t argc) {
+    // Worst case for integers is 10 bytes each, strings are capped
+    // to BLOG_BIN_MAX_STR, rest of the header fits in 32 bytes.
+    char rec[32 + (BLOG_BIN_MAX_ARGS * (BLOG_BIN_MAX_STR + 1))];
+    uint64_t strmask = 0;
+    size_t off = 0;
+
+    if (argc > BLOG_BIN_MAX_ARGS) {
+        argc = BLOG_BIN_MAX_ARGS;
+    }
+    for (uint8_t i = 0; i < argc; i++) {
+        if (args[i].is_str) {
+            strmask |= (1ULL << i);
+        }
+    }
+    rec[off++] = (char)BLOG_BIN_MAGIC;
+    rec[off++] = (char)level;
+    off = blog_bin_put_uleb(rec, off, (uint64_t)fmt);
+    off = blog_bin_put_uleb(rec, off, argc);
+    off = blog_bin_put_uleb(rec, off, strmask);
+
+    for (uint8_t i = 0; i < argc; i++) {
+        if (args[i].is_str == false) {
+            off = blog_bin_put_uleb(rec, off, args[i].value);
+            continue;
+        }
+        const char *s = (const char *)args[i].value;
+        if (!s) {
+            // Same as text sinks print
+            s = "(null)";
+        }
+        for (size_t j = 0; s[j] && (j < BLOG_BIN_MAX_STR); j++) {
+            rec[off++] = s[j];
+        }
+        rec[off++] = 0;
+    }
+    console_write_binary(level, rec, off);
+}
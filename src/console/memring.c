@@ -0,0 +1,116 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2026, k4m1 <me@k4m1.net>
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+ 
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+ 
+ 3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <drivers/device.h>
+
+#include <mainboards/memory_init.h>
+
+#include <console/console.h>
+#include <console/memring.h>
+
+/* Check if log region holds a header we can keep appending to
+ *
+ * @param console_memring_header *ring -- log region
+ * @return bool true if header is sane
+ */
+static bool memring_valid(console_memring_header *ring) {
+    if (strncmp((unsigned char *)ring->signature, (unsigned char *)MEMRING_SIGNATURE, 
+                sizeof(ring->signature)) != 0) {
+        return false;
+    }
+    if (ring->size != (MEMRING_SIZE - sizeof(console_memring_header))) {
+        return false;
+    }
+    return (ring->cursor < ring->size);
+}
+
+/* Find or set up persistent console log region
+ *
+ * @param device *dev -- memring device structure
+ * @return status_initialised on success
+ */
+enum DEVICE_STATUS memring_init(device *dev) {
+    console_memring *mdev = dev->device_data;
+    console_memring_header *ring = (console_memring_header *)MEMRING_BASE;
+
+    if (memring_valid(ring) == false) {
+        memcpy(MEMRING_SIGNATURE, ring->signature, sizeof(ring->signature));
+        ring->size = (MEMRING_SIZE - sizeof(console_memring_header));
+        ring->cursor = 0;
+        ring->flags = 0;
+        ring->boot_count = 0;
+    }
+    ring->boot_count++;
+    mdev->ring = ring;
+    return status_initialised;
+}
+
+/* Mark console log region reserved in memory map
+ *
+ * @param memory_map *map -- memory map to add region to
+ */
+void memring_reserve(memory_map *map) {
+    mmap_reserve(map, MEMRING_BASE, MEMRING_SIZE);
+}
+
+/* Console sink write function for in-memory log. This is just a copy,
+ * so it's cheap enough to take everything we log.
+ *
+ * @param device *dev     -- memring device structure
+ * @param const char *msg -- data to write
+ * @param size_t len      -- amount of bytes to write
+ * @return size_t bytes written
+ */
+size_t memring_console_write(device *dev, const char *msg, size_t len) {
+    console_memring_header *ring = ((console_memring *)dev->device_data)->ring;
+    size_t done = 0;
+
+    while (done < len) {
+        size_t chunk = (ring->size - ring->cursor);
+        if (chunk > (len - done)) {
+            chunk = (len - done);
+        }
+        memcpy(&msg[done], &ring->data[ring->cursor], chunk);
+        ring->cursor += chunk;
+        done += chunk;
+        if (ring->cursor == ring->size) {
+            ring->cursor = 0;
+            ring->flags |= MEMRING_FLAG_WRAPPED;
+        }
+    }
+    return len;
+}
@@ -0,0 +1,499 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2026, k4m1 <me@k4m1.net>
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+ 
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+ 
+ 3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <console/console.h>
+#include <cpu/common.h>
+#include <cpu/smp.h>
+#include <mm/paging.h>
+
+#include <drivers/lapic/lapic.h>
+#include <interrupts/idt.h>
+#include <mainboards/config.h>
+#include <mainboards/memory_init.h>
+#include <stacks/task.h>
+#include <time/clock.h>
+
+// ACPI tables, just as much as we need to count cpus from MADT
+typedef struct __attribute__((packed)) {
+    char signature[8];
+    uint8_t checksum;
+    char oem_id[6];
+    uint8_t revision;
+    uint32_t rsdt;
+    uint32_t length;
+    uint64_t xsdt;
+    uint8_t ext_checksum;
+    uint8_t reserved[3];
+} acpi_rsdp;
+
+typedef struct __attribute__((packed)) {
+    char signature[4];
+    uint32_t length;
+    uint8_t revision;
+    uint8_t checksum;
+    char oem_id[6];
+    char oem_table_id[8];
+    uint32_t oem_revision;
+    uint32_t creator_id;
+    uint32_t creator_revision;
+} acpi_sdt_header;
+
+// MADT has lapic address and flags before its entries
+#define ACPI_MADT_ENTRIES       (sizeof(acpi_sdt_header) + 8)
+#define ACPI_MADT_LAPIC         0
+#define ACPI_MADT_X2APIC        9
+#define ACPI_MADT_ENABLED       1
+
+extern uint8_t smp_trampoline_start[];
+extern uint8_t smp_trampoline_data[];
+extern uint8_t smp_trampoline_end[];
+
+smp_state smp = {
+    .count = 0
+};
+
+// Boot cpu until smp.cpu[] exists
+static percpu_data smp_boot_cpu;
+
+// Wakeup IPI only needs to end hlt of an idle AP
+void __attribute__((section(".rom_int_handler"), interrupt)) smp_wake_int_handler(int_stack_frame *frame __attribute__((unused))) {
+    lapic_eoi();
+}
+
+/* Wake up idle APs. Busy ones get the IPI next time they go idle and
+ * look for work once more.
+ */
+static void smp_wake_idle(void) {
+    lapic_send_ipi(0, (LAPIC_ICR_ASSERT | LAPIC_ICR_ALL_BUT_SELF | SMP_WAKE_VECTOR));
+}
+
+/* Add up bytes of ACPI structure, valid ones sum up to 0
+ *
+ * @param const uint8_t *p -- structure
+ * @param uint32_t len     -- length of structure
+ * @return uint8_t checksum
+ */
+static uint8_t acpi_checksum(const uint8_t *p, uint32_t len) {
+    uint8_t sum = 0;
+    for (uint32_t i = 0; i < len; i++) {
+        sum += p[i];
+    }
+    return sum;
+}
+
+/* Look for RSDP between given addresses, it's 16 byte aligned
+ *
+ * @param uint64_t start -- where to start looking
+ * @param uint64_t end   -- where to stop
+ * @return acpi_rsdp * or NULL if not found
+ */
+static acpi_rsdp *acpi_find_rsdp_in(uint64_t start, uint64_t end) {
+    for (uint64_t addr = start; addr < end; addr += 16) {
+        acpi_rsdp *rsdp = (acpi_rsdp *)addr;
+        if ((strncmp((unsigned char *)rsdp->signature, (unsigned char *)"RSD PTR ", 8) == 0) &&
+            (acpi_checksum((uint8_t *)rsdp, 20) == 0)) {
+            return rsdp;
+        }
+    }
+    return NULL;
+}
+
+/* Find MADT through RSDT, if whoever ran before us left ACPI tables
+ * in memory.
+ *
+ * @return acpi_sdt_header * to MADT or NULL if not found
+ */
+static acpi_sdt_header *acpi_find_madt(void) {
+    uint64_t ebda = ((uint64_t)(*(uint16_t *)0x040E) << 4);
+    acpi_rsdp *rsdp = NULL;
+    if ((ebda >= 0x80000) && (ebda < 0xA0000)) {
+        rsdp = acpi_find_rsdp_in(ebda, (ebda + 0x400));
+    }
+    if (rsdp == NULL) {
+        rsdp = acpi_find_rsdp_in(0xE0000, 0x100000);
+    }
+    if ((rsdp == NULL) || (rsdp->rsdt == 0)) {
+        return NULL;
+    }
+
+    acpi_sdt_header *rsdt = (acpi_sdt_header *)(uint64_t)rsdp->rsdt;
+    if ((map_address(rsdt, sizeof(acpi_sdt_header)) == false) || 
+        (map_address(rsdt, rsdt->length) == false) ||
+        (acpi_checksum((uint8_t *)rsdt, rsdt->length) != 0)) {
+        return NULL;
+    }
+    uint32_t *tables = (uint32_t *)((uint8_t *)rsdt + sizeof(acpi_sdt_header));
+    uint32_t count = ((rsdt->length - sizeof(acpi_sdt_header)) / sizeof(uint32_t));
+    for (uint32_t i = 0; i < count; i++) {
+        acpi_sdt_header *sdt = (acpi_sdt_header *)(uint64_t)tables[i];
+        if (map_address(sdt, sizeof(acpi_sdt_header)) == false) {
+            continue;
+        }
+        if (strncmp((unsigned char *)sdt->signature, (unsigned char *)"APIC", 4) == 0) {
+            if (map_address(sdt, sdt->length) == false) {
+                return NULL;
+            }
+            return sdt;
+        }
+    }
+    return NULL;
+}
+
+/* Count enabled local apics listed in MADT
+ *
+ * @return uint32_t cpu count, or 0 if there's no MADT
+ */
+static uint32_t smp_madt_cpu_count(void) {
+    acpi_sdt_header *madt = acpi_find_madt();
+    if (madt == NULL) {
+        return 0;
+    }
+    uint32_t count = 0;
+    uint8_t *entry = ((uint8_t *)madt + ACPI_MADT_ENTRIES);
+    uint8_t *end = ((uint8_t *)madt + madt->length);
+    while ((entry + 2) <= end) {
+        uint8_t type = entry[0];
+        uint8_t len = entry[1];
+        if ((len < 2) || ((entry + len) > end)) {
+            break;
+        }
+        if ((type == ACPI_MADT_LAPIC) && (len >= 8) && 
+            ((*(uint32_t *)&entry[4]) & ACPI_MADT_ENABLED)) {
+            count++;
+        } else if ((type == ACPI_MADT_X2APIC) && (len >= 16) &&
+            ((*(uint32_t *)&entry[8]) & ACPI_MADT_ENABLED)) {
+            count++;
+        }
+        entry += len;
+    }
+    return count;
+}
+
+/* Take newest work of our own queue
+ *
+ * @param smp_work_queue *queue -- our queue
+ * @param smp_work *work        -- where to store work item
+ * @return bool true if we got work
+ */
+static bool smp_queue_pop(smp_work_queue *queue, smp_work *work) {
+    bool ret = false;
+    spin_lock(&queue->lock);
+    if (queue->tail != queue->head) {
+        queue->tail--;
+        *work = queue->work[queue->tail % SMP_QUEUE_SIZE];
+        ret = true;
+    }
+    spin_unlock(&queue->lock);
+    return ret;
+}
+
+/* Take oldest work of someone else's queue
+ *
+ * @param smp_work_queue *queue -- queue to steal from
+ * @param smp_work *work        -- where to store work item
+ * @return bool true if we got work
+ */
+static bool smp_queue_steal(smp_work_queue *queue, smp_work *work) {
+    bool ret = false;
+    spin_lock(&queue->lock);
+    if (queue->tail != queue->head) {
+        *work = queue->work[queue->head % SMP_QUEUE_SIZE];
+        queue->head++;
+        ret = true;
+    }
+    spin_unlock(&queue->lock);
+    return ret;
+}
+
+/* Run one work item, from our own queue if there's any, otherwise 
+ * steal from the next cpu that has some.
+ *
+ * @param uint32_t self -- our cpu index
+ * @return bool true if we ran something
+ */
+static bool smp_run_one(uint32_t self) {
+    smp_cpu *cpu = &smp.cpu[self];
+    smp_work work;
+
+    if (smp_queue_pop(&cpu->queue, &work) == false) {
+        bool found = false;
+        for (uint32_t i = 1; i < smp.count; i++) {
+            smp_cpu *victim = &smp.cpu[((self + i) % smp.count)];
+            if (victim->online && smp_queue_steal(&victim->queue, &work)) {
+                cpu->stolen++;
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            return false;
+        }
+    }
+    work.fn(work.arg);
+    cpu->done++;
+    atomic_dec(&work.group->pending);
+    return true;
+}
+
+/* C entry point of application processors, from trampoline
+ *
+ * @param uint32_t index -- our index in smp.cpu[]
+ */
+static void __attribute__((noreturn)) smp_ap_main(uint32_t index) {
+    smp_cpu *cpu = &smp.cpu[index];
+
+    write_idtr((void *)idt);
+    cpu->percpu.index = index;
+    cpu->percpu.apic_id = (cpuid(CPUID_FEATURES, 0).ebx >> 24);
+    percpu_init(&cpu->percpu);
+    lapic_ap_init();
+    cpu->online = true;
+    atomic_inc(&smp.online);
+
+    while (smp.park == false) {
+        if (smp_run_one(index)) {
+            continue;
+        }
+        // Whoever queues work after we're counted idle wakes us up, 
+        // so look once more before halting. Wakeup that came in
+        // meanwhile is pending and ends hlt right away.
+        atomic_inc(&smp.idle);
+        if ((smp_run_one(index) == false) && (smp.park == false)) {
+            sti_halt();
+            cli();
+        }
+        atomic_dec(&smp.idle);
+    }
+    // Blocks sitting in our caches would be lost for good
+    heap_cache_drain();
+    cpu->online = false;
+    hang();
+}
+
+/* Set up per-cpu data of boot cpu, before anything allocates or logs.
+ */
+void smp_boot_cpu_init(void) {
+    smp_boot_cpu.index = 0;
+    smp_boot_cpu.heap = NULL;
+    percpu_init(&smp_boot_cpu);
+}
+
+/* Mark trampoline page reserved in memory map
+ *
+ * @param memory_map *map -- memory map to add region to
+ */
+void smp_reserve(memory_map *map) {
+    mmap_reserve(map, SMP_TRAMPOLINE_BASE, SMP_TRAMPOLINE_SIZE);
+}
+
+/* Find out how many cpus we have, mainboard knows best and MADT 
+ * left behind by earlier firmware is next best.
+ *
+ * @return uint32_t cpu count, 0 if we can't tell
+ */
+static uint32_t smp_cpu_count(void) {
+    uint32_t count = mainboard_cpu_count();
+    if (count) {
+        blogf_debug("%u cpus according to mainboard\n", count);
+        return count;
+    }
+    count = smp_madt_cpu_count();
+    if (count) {
+        blogf_debug("%u cpus according to MADT\n", count);
+    }
+    return count;
+}
+
+/* Copy trampoline to low memory, give it page tables, entry point 
+ * and stacks.
+ *
+ * @return bool true if we have everything APs need
+ */
+static bool smp_setup_trampoline(void) {
+    uint64_t *stacks = calloc(smp.count, sizeof(uint64_t));
+    if (stacks == NULL) {
+        return false;
+    }
+    for (uint32_t i = 1; i < smp.count; i++) {
+        uint8_t *stack = malloc(SMP_AP_STACK_SIZE);
+        if (stack == NULL) {
+            // Those we have no stack for stay parked in trampoline
+            blogf_warning("Stacks for %u of %u APs only\n", (i - 1), (smp.count - 1));
+            smp.count = i;
+            break;
+        }
+        stacks[i] = (((uint64_t)stack + SMP_AP_STACK_SIZE) & ~0x0FULL);
+        // Small allocations on APs stay off main heap lock
+        smp.cpu[i].percpu.heap = heap_arena_create(SMP_AP_HEAP_SIZE);
+    }
+
+    size_t len = (size_t)(smp_trampoline_end - smp_trampoline_start);
+    memcpy(smp_trampoline_start, (void *)SMP_TRAMPOLINE_BASE, len);
+
+    uint64_t cr3;
+    asm volatile("mov   %0, cr3":"=r"(cr3));
+    smp_trampoline_params *params = (smp_trampoline_params *)(SMP_TRAMPOLINE_BASE + 
+            (smp_trampoline_data - smp_trampoline_start));
+    params->cr3 = cr3;
+    params->entry = (uint64_t)smp_ap_main;
+    params->stacks = (uint64_t)stacks;
+    params->next = 1;
+    params->max = smp.count;
+    return true;
+}
+
+/* Find out how many cpus we have and start application processors
+ * with INIT-SIPI-SIPI. APs take work from queues and halt while 
+ * there's none. Needs local apic.
+ *
+ * @return bool true if any AP came up
+ */
+bool smp_init(void) {
+    uint32_t count = smp_cpu_count();
+    if (count > SMP_MAX_CPUS) {
+        blogf_warning("%u cpus, using first %u\n", count, SMP_MAX_CPUS);
+        count = SMP_MAX_CPUS;
+    }
+    if (count == 0) {
+        blogf_warning("Can't tell how many cpus we have, APs stay down\n");
+        count = 1;
+    }
+    smp.cpu = calloc(count, sizeof(smp_cpu));
+    if (smp.cpu == NULL) {
+        return false;
+    }
+    smp.count = count;
+    // Caches of boot cpu move along, nothing allocates in between
+    smp.cpu[0].percpu = smp_boot_cpu;
+    smp.cpu[0].percpu.apic_id = (local_apic ? local_apic->id : 0);
+    percpu_init(&smp.cpu[0].percpu);
+    smp.cpu[0].online = true;
+    atomic_set(&smp.online, 1);
+    if ((count == 1) || (local_apic == NULL) || (smp_setup_trampoline() == false)) {
+        return false;
+    }
+    add_interrupt_handler(SMP_WAKE_VECTOR, (uint64_t)smp_wake_int_handler);
+
+    uint64_t start = now_ns();
+    // Broadcast wakes APs we don't know apic ids of, too
+    if (lapic_send_ipi(0, (LAPIC_ICR_INIT | LAPIC_ICR_ASSERT | LAPIC_ICR_LEVEL | 
+                    LAPIC_ICR_ALL_BUT_SELF)) == false) {
+        blogf_error("INIT IPI not accepted\n");
+        return false;
+    }
+    (void)wait_until(false, SMP_INIT_DELAY_US);
+    for (int i = 0; i < 2; i++) {
+        lapic_send_ipi(0, (LAPIC_ICR_STARTUP | LAPIC_ICR_ALL_BUT_SELF | SMP_TRAMPOLINE_VECTOR));
+        if (wait_until((atomic_read(&smp.online) == smp.count), SMP_SIPI_DELAY_US)) {
+            break;
+        }
+    }
+    if (wait_until((atomic_read(&smp.online) == smp.count), SMP_AP_TIMEOUT_US) == false) {
+        blogf_warning("Only %lu of %u cpus checked in\n", atomic_read(&smp.online), smp.count);
+    }
+    blogf("%lu cpus online in %lu us\n", atomic_read(&smp.online), ((now_ns() - start) / 1000));
+    return (atomic_read(&smp.online) > 1);
+}
+
+/* Queue work for any cpu to run, and wake up idle APs. APs run it 
+ * with interrupts disabled, and as tasks are boot cpu only, yield()
+ * there is just a pause. Work may poll with wait_until() but must not
+ * sleep. Runs right away if queue is full.
+ *
+ * @param smp_work_group *group -- group to count work in
+ * @param smp_work_fn fn        -- function to run
+ * @param void *arg             -- argument to pass to fn
+ */
+void smp_queue_work(smp_work_group *group, smp_work_fn fn, void *arg) {
+    if (smp.cpu == NULL) {
+        fn(arg);
+        return;
+    }
+    smp_work_queue *queue = &smp.cpu[smp_cpu_index()].queue;
+    atomic_inc(&group->pending);
+
+    spin_lock(&queue->lock);
+    if ((queue->tail - queue->head) < SMP_QUEUE_SIZE) {
+        smp_work *work = &queue->work[queue->tail % SMP_QUEUE_SIZE];
+        work->fn = fn;
+        work->arg = arg;
+        work->group = group;
+        queue->tail++;
+        // AP going idle counts itself before taking queue locks to look
+        // for work, so it either sees this work or we see it idle
+        bool wake = (atomic_read(&smp.idle) != 0);
+        spin_unlock(&queue->lock);
+        if (wake) {
+            smp_wake_idle();
+        }
+        return;
+    }
+    spin_unlock(&queue->lock);
+    fn(arg);
+    atomic_dec(&group->pending);
+}
+
+/* Wait until all work in group is done, helping out meanwhile. Other
+ * tasks get to run if there's nothing to do but wait.
+ *
+ * @param smp_work_group *group -- group to wait for
+ */
+void smp_work_wait(smp_work_group *group) {
+    uint32_t self = smp_cpu_index();
+    while (atomic_read(&group->pending)) {
+        if (smp_run_one(self) == false) {
+            yield();
+        }
+    }
+}
+
+/* Stop APs from taking work, they halt with interrupts disabled.
+ * Done before handing machine over to payload.
+ */
+void smp_park(void) {
+    if (smp.cpu == NULL) {
+        return;
+    }
+    smp.park = true;
+    if (atomic_read(&smp.online) > 1) {
+        smp_wake_idle();
+    }
+    for (uint32_t i = 1; i < smp.count; i++) {
+        blogf_debug("cpu %u: apic id %u, %lu work items, %lu stolen\n", i, 
+                smp.cpu[i].percpu.apic_id, smp.cpu[i].done, smp.cpu[i].stolen);
+    }
+}
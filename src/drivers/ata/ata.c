@@ -38,6 +38,7 @@
 #include <drivers/ata/ata.h>
 
 #include <console/console.h>
+#include <cpu/smp.h>
 
 #include <stdbool.h>
 #include <stdint.h>
@@ -88,8 +89,8 @@ static enum ata_drive_id ata_identify_drive(ata_bus *bus) {
         return id;
     }
     reg.raw = 0;
-    reg.status.drive_busy = false;
-    if (ata_waitfor_status(bus, reg.raw, false, 50) == false) {
+    reg.status.drive_busy = true;
+    if (ata_waitfor_status(bus, reg.raw, false, ATA_STATUS_TIMEOUT_US) == false) {
         return ata_drive_id_not_ata;
     }
     id = ata_try_read_id(bus);
@@ -98,7 +99,7 @@ static enum ata_drive_id ata_identify_drive(ata_bus *bus) {
     }
     reg.raw = 0;
     reg.status.drive_ready = true;
-    if (ata_waitfor_status(bus, reg.raw, true, 50) == false) {
+    if (ata_waitfor_status(bus, reg.raw, true, ATA_STATUS_TIMEOUT_US) == false) {
         return ata_drive_id_not_ata;
     }
     return ata_drive_id_ata;
@@ -165,16 +166,44 @@ static ata_bus *init_ata_bus(uint16_t base, uint16_t dcr) {
     return ret;
 }
 
+/* Compatibility mode bus to probe, and what we found there
+ *
+ * @member uint16_t base -- io base of bus
+ * @member ata_bus *bus  -- bus structure, NULL if nothing is there
+ */
+typedef struct {
+    uint16_t base;
+    ata_bus *bus;
+} ata_bus_probe;
+
+/* Work item probing one bus. Buses have ports of their own, so they
+ * are probed on whichever cpus are free.
+ *
+ * @param void *arg -- ata_bus_probe of bus
+ */
+static void ata_probe_bus_work(void *arg) {
+    ata_bus_probe *probe = arg;
+    probe->bus = init_ata_bus(probe->base, ata_comp_base_to_dcr(probe->base));
+}
+
 static void ata_init_all_buses(ata_ide *ide) {
     if (ide->iface.pci_primary_native_enabled) {
         /* TODO */
     } else {
+        ata_bus_probe probe[4];
+        smp_work_group group = {
+            .pending = ATOMIC_INIT(0)
+        };
+        for (int i = 0; i < 4; i++) {
+            probe[i].base = ata_ide_compability_base_addrs[i];
+            probe[i].bus  = NULL;
+            smp_queue_work(&group, ata_probe_bus_work, &probe[i]);
+        }
+        smp_work_wait(&group);
+        // Keep buses in the same order no matter who probed them
         for (int i = 0; i < 4; i++) {
-            uint16_t base = ata_ide_compability_base_addrs[i];
-            uint16_t dcr  = ata_comp_base_to_dcr(base);
-            ata_bus *bus  = init_ata_bus(base, dcr);
-            if (bus) {
-                ide->bus_array[ide->bus_count] = bus;
+            if (probe[i].bus) {
+                ide->bus_array[ide->bus_count] = probe[i].bus;
                 ide->bus_count++;
             }
         }
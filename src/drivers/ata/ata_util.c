@@ -39,6 +39,9 @@
 
 #include <console/console.h>
 
+#include <time/clock.h>
+#include <stacks/task.h>
+
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -79,15 +82,16 @@ void ata_bus_reset(ata_bus *bus) {
 
 /* Wait for given ata settings to change at status register
  *
- * @param ata_bus *bus -- Ata bus we're working with
- * @param uint8_t mask -- Flags to wait for
- * @param bool set     -- Are we waiting for these flags to be set or clear
- * @param uint8_t wait -- Timeout 
+ * @param ata_bus *bus          -- Ata bus we're working with
+ * @param uint8_t mask          -- Flags to wait for
+ * @param bool set              -- Are we waiting for these flags to be set or clear
+ * @param uint32_t timeout_us   -- How long to wait in microseconds
  * @return bool true if changes happen, false if timeout or error is encountered
  */
-bool ata_waitfor_status(ata_bus *bus, uint8_t mask, bool set, uint8_t wait) {
+bool ata_waitfor_status(ata_bus *bus, uint8_t mask, bool set, uint32_t timeout_us) {
     ata_register reg = {0};
-    for ( ; wait > 0; wait--) {
+    uint64_t deadline = deadline_us(timeout_us);
+    do {
         reg = ata_read_status(bus);
         if (reg.status.error) {
             break;
@@ -99,7 +103,8 @@ bool ata_waitfor_status(ata_bus *bus, uint8_t mask, bool set, uint8_t wait) {
         if (!set && (reg.raw == 0)) {
             return true;
         }
-    }
+        yield();
+    } while (!deadline_passed(deadline));
     return false;
 }
 
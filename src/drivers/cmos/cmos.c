@@ -59,10 +59,10 @@ static inline bool rtc_in_12hr_mode(uint8_t status) {
 enum DEVICE_STATUS cmos_init(device *dev) {
     cmos_data *cdata = dev->device_data;
 
-    for (cdata->iodelay = 0; cdata->iodelay < 0x500; cdata->iodelay++) {
-        // TODO: Fix -- SLOW, Get multitasking going so we aren't stuck in poll-loops
-        //
-        do {} while (cmos_rtc_update_ongoing(dev));
+    for (cdata->iodelay = 0; cdata->iodelay <= CMOS_MAX_IODELAY_US; cdata->iodelay++) {
+        if (!wait_until(!cmos_rtc_update_ongoing(dev), CMOS_UIP_TIMEOUT_US)) {
+            continue;
+        }
 
         uint8_t v = cmos_read(dev, rtc_month);
         if (!v || (v > 0x12)) {
@@ -0,0 +1,86 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2026, k4m1 <me@k4m1.net>
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+ 
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+ 
+ 3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <sys/io.h>
+
+#include <drivers/device.h>
+#include <drivers/debugcon/debugcon.h>
+
+#include <mainboards/config.h>
+
+/* Initialise debug console. Mainboard configuration gets asked for port 
+ * first, if that doesn't say anything we probe the default port.
+ *
+ * @param device *dev -- device structure for debugcon
+ * @return status_initialised if debug console is present
+ */
+enum DEVICE_STATUS debugcon_init(device *dev) {
+    debugcon_device *ddev = dev->device_data;
+    unsigned short port = mainboard_debugcon_port();
+
+    if (port == 0) {
+        if (debugcon_probe(DEBUGCON_DEFAULT_PORT) == false) {
+            return status_not_present;
+        }
+        port = DEBUGCON_DEFAULT_PORT;
+    }
+    ddev->base_port = port;
+    return status_initialised;
+}
+
+/* Write data to debug console. The whole buffer goes out with a single
+ * rep outsb, there's no FIFO or line status to wait for.
+ *
+ * @param unsigned short port -- debugcon port
+ * @param const char *msg     -- data to write
+ * @param size_t len          -- amount of bytes to write
+ * @return size_t bytes written
+ */
+size_t debugcon_tx(unsigned short port, const char *msg, size_t len) {
+    outsb(port, msg, len);
+    return len;
+}
+
+/* Console sink write function for debug console
+ *
+ * @param device *dev     -- debugcon device structure
+ * @param const char *msg -- data to write
+ * @param size_t len      -- amount of bytes to write
+ * @return size_t bytes written
+ */
+size_t debugcon_console_write(device *dev, const char *msg, size_t len) {
+    debugcon_device *ddev = dev->device_data;
+    return debugcon_tx(ddev->base_port, msg, len);
+}
@@ -30,11 +30,14 @@
  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 
 #include <panic.h>
 #include <drivers/device.h>
 #include <console/console.h>
+#include <time/clock.h>
+#include <time/timestamp.h>
 
 
 /* Helper for allocating new device structures
@@ -82,17 +85,21 @@ static inline char *status_to_str(enum DEVICE_STATUS status) {
  * @param char *name -- device name
  */
 void initialize_device(device_init_function init, device *dev, char *name, bool critical) {
-    blogf("Initializing %s... ", name);
+    uint64_t start = now_ns();
 
+    // Other tasks may print while we wait, so result goes out as one line
+    timestamp(ts_device_start, name);
     dev->status = init(dev);
+    timestamp(ts_device_end, name);
     dev->device_name = name;
+    uint64_t took_us = ((now_ns() - start) / 1000);
     if (dev->status != status_initialised) {
-        blogf("Failed, reason: %s\n", status_to_str(dev->status));
+        blogf("Initializing %s... Failed, reason: %s (%lu us)\n", name, 
+                status_to_str(dev->status), took_us);
         if (critical) {
             panic("Unable to initialize a critical component");
         }
     } else {
-        blog("ok\n");
+        blogf("Initializing %s... ok (%lu us)\n", name, took_us);
     }
 }
-
@@ -0,0 +1,241 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2026, k4m1 <me@k4m1.net>
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+ 
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+ 
+ 3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <drivers/device.h>
+#include <drivers/fbcon/fbcon.h>
+
+/* Get first scanline of a text row
+ *
+ * @param fbcon_console *con -- console
+ * @param uint32_t row       -- row relative to top of screen
+ * @return uint32_t scanline
+ */
+static inline uint32_t fbcon_row_y(fbcon_console *con, uint32_t row) {
+    if (con->mirror) {
+        row = ((con->top + row) % con->rows);
+    }
+    return (row * FBCON_CELL_HEIGHT);
+}
+
+/* Fill scanlines with background colour
+ *
+ * @param fbcon_console *con -- console
+ * @param uint32_t y         -- first scanline
+ * @param uint32_t count     -- amount of scanlines
+ */
+static void fbcon_clear_lines(fbcon_console *con, uint32_t y, uint32_t count) {
+    uint64_t bg = (((uint64_t)FBCON_BG_COLOUR << 32) | FBCON_BG_COLOUR);
+    for (uint32_t line = y; line < (y + count); line++) {
+        uint64_t *dst = (uint64_t *)&con->fb.base[(line * con->fb.pitch)];
+        for (uint32_t x = 0; x < (con->fb.width / 2); x++) {
+            dst[x] = bg;
+        }
+    }
+}
+
+/* Clear a text row, and its mirror if we have one
+ *
+ * @param fbcon_console *con -- console
+ * @param uint32_t row       -- row relative to top of screen
+ */
+static void fbcon_clear_row(fbcon_console *con, uint32_t row) {
+    uint32_t y = fbcon_row_y(con, row);
+    fbcon_clear_lines(con, y, FBCON_CELL_HEIGHT);
+    if (con->mirror) {
+        fbcon_clear_lines(con, (y + (con->rows * FBCON_CELL_HEIGHT)), FBCON_CELL_HEIGHT);
+    }
+}
+
+/* Draw a single glyph. Each font row is a lookup into pre-expanded
+ * pixel rows, so a glyph is just 16 32-byte copies.
+ *
+ * @param fbcon_console *con -- console
+ * @param uint32_t y         -- first scanline of character cell
+ * @param uint32_t x         -- first pixel of character cell
+ * @param const uint8_t *glyph -- font bitmap
+ */
+static void fbcon_draw_glyph(fbcon_console *con, uint32_t y, uint32_t x, const uint8_t *glyph) {
+    uint32_t *dst = &con->fb.base[((y * con->fb.pitch) + x)];
+    for (int i = 0; i < 8; i++) {
+        const uint64_t *src = (const uint64_t *)con->expand[glyph[i]];
+        for (int copy = 0; copy < 2; copy++) {
+            uint64_t *line = (uint64_t *)dst;
+            line[0] = src[0];
+            line[1] = src[1];
+            line[2] = src[2];
+            line[3] = src[3];
+            dst += con->fb.pitch;
+        }
+    }
+}
+
+/* Draw character at cursor position
+ *
+ * @param fbcon_console *con -- console
+ * @param char c             -- character to draw
+ */
+static void fbcon_putc(fbcon_console *con, char c) {
+    unsigned char uc = (unsigned char)c;
+    if ((uc < FBCON_FONT_FIRST) || (uc > FBCON_FONT_LAST)) {
+        uc = '?';
+    }
+    const uint8_t *glyph = fbcon_font_8x8[(uc - FBCON_FONT_FIRST)];
+    uint32_t y = fbcon_row_y(con, con->cy);
+    uint32_t x = (con->cx * FBCON_CELL_WIDTH);
+
+    fbcon_draw_glyph(con, y, x, glyph);
+    if (con->mirror) {
+        fbcon_draw_glyph(con, (y + (con->rows * FBCON_CELL_HEIGHT)), x, glyph);
+    }
+}
+
+/* Scroll screen up by one text row
+ *
+ * @param fbcon_console *con -- console
+ */
+static void fbcon_scroll(fbcon_console *con) {
+    if (con->mirror) {
+        // Old top row becomes the new bottom one
+        con->top = ((con->top + 1) % con->rows);
+        fbcon_clear_row(con, (con->rows - 1));
+        con->fb.pan(con->fb.hw, (con->top * FBCON_CELL_HEIGHT));
+        return;
+    }
+    uint32_t lines = ((con->rows - 1) * FBCON_CELL_HEIGHT);
+    for (uint32_t line = 0; line < lines; line++) {
+        uint64_t *dst = (uint64_t *)&con->fb.base[(line * con->fb.pitch)];
+        uint64_t *src = (uint64_t *)&con->fb.base[((line + FBCON_CELL_HEIGHT) * con->fb.pitch)];
+        for (uint32_t x = 0; x < (con->fb.width / 2); x++) {
+            dst[x] = src[x];
+        }
+    }
+    fbcon_clear_row(con, (con->rows - 1));
+}
+
+/* Move cursor to start of next line, scrolling if needed
+ *
+ * @param fbcon_console *con -- console
+ */
+static void fbcon_newline(fbcon_console *con) {
+    con->cx = 0;
+    if ((con->cy + 1) < con->rows) {
+        con->cy++;
+    } else {
+        fbcon_scroll(con);
+    }
+}
+
+/* Set up framebuffer console, fbcon_console.fb must be filled in
+ * before calling this.
+ *
+ * @param device *dev -- fbcon device structure
+ * @return status_initialised on success
+ */
+enum DEVICE_STATUS fbcon_init(device *dev) {
+    fbcon_console *con = dev->device_data;
+    if (!con->fb.base || (con->fb.width < FBCON_CELL_WIDTH) || 
+            (con->fb.height < FBCON_CELL_HEIGHT)) {
+        return status_not_present;
+    }
+    con->cols = (con->fb.width / FBCON_CELL_WIDTH);
+    con->rows = (con->fb.height / FBCON_CELL_HEIGHT);
+    con->cx = 0;
+    con->cy = 0;
+    con->top = 0;
+    con->mirror = (con->fb.pan && 
+            (con->fb.virt_height >= (2 * con->rows * FBCON_CELL_HEIGHT)));
+
+    // Every possible font row expanded to pixels, 8KB
+    con->expand = malloc(256 * sizeof(*con->expand));
+    if (!con->expand) {
+        return status_faulty;
+    }
+    for (uint32_t bits = 0; bits < 256; bits++) {
+        for (uint32_t px = 0; px < FBCON_CELL_WIDTH; px++) {
+            bool set = (bits & (0x80 >> px));
+            con->expand[bits][px] = (set) ? FBCON_FG_COLOUR : FBCON_BG_COLOUR;
+        }
+    }
+
+    uint32_t lines = (con->rows * FBCON_CELL_HEIGHT);
+    fbcon_clear_lines(con, 0, ((con->mirror) ? (2 * lines) : lines));
+    if (con->fb.pan) {
+        con->fb.pan(con->fb.hw, 0);
+    }
+    return status_initialised;
+}
+
+/* Console sink write function for framebuffer console
+ *
+ * @param device *dev     -- fbcon device structure
+ * @param const char *msg -- data to write
+ * @param size_t len      -- amount of bytes to write
+ * @return size_t bytes written
+ */
+size_t fbcon_console_write(device *dev, const char *msg, size_t len) {
+    fbcon_console *con = dev->device_data;
+
+    for (size_t i = 0; i < len; i++) {
+        switch (msg[i]) {
+        case '\n':
+            fbcon_newline(con);
+            break;
+        case '\r':
+            con->cx = 0;
+            break;
+        case '\t':
+            if (con->cx >= con->cols) {
+                fbcon_newline(con);
+            }
+            do {
+                fbcon_putc(con, ' ');
+                con->cx++;
+            } while ((con->cx % 8) && (con->cx < con->cols));
+            break;
+        default:
+            // Wrap only once there's something to put on next line,
+            // so that full line followed by newline doesn't leave an
+            // empty one behind.
+            if (con->cx >= con->cols) {
+                fbcon_newline(con);
+            }
+            fbcon_putc(con, msg[i]);
+            con->cx++;
+            break;
+        }
+    }
+    return len;
+}
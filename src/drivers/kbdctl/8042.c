@@ -39,6 +39,9 @@
 
 #include <console/console.h>
 
+#include <time/clock.h>
+#include <stacks/task.h>
+
 #include <panic.h>
 
 #define WAITFOR_READ KBDCTL_STAT_OUT_BUF
@@ -58,12 +61,7 @@ static bool kbdctl_ctrl_rdy(int waitfor) {
     } else {
         mask = KBDCTL_STAT_IN_BUF;
     }
-    for (int i = 0; i < 5000; i++) {
-        if ((inb(KBDCTL_STAT) & mask) == waitfor) {
-            return true;
-        }
-    }
-    return false;
+    return wait_until(((inb(KBDCTL_STAT) & mask) == waitfor), KBDCTL_TIMEOUT_US);
 }
 
 // Send command to kbd controller, read response
@@ -85,7 +83,7 @@ bool kbdctl_send_cmd(unsigned char v) {
 //
 unsigned char kbdctl_recv_data_poll(void) { 
     if (kbdctl_ctrl_rdy(WAITFOR_READ) == false) {
-        blog("kbdctl_recv_data_poll timeout\n");
+        blog_warning("kbdctl_recv_data_poll timeout\n");
         return 0xff;
     }
     return inb(KBDCTL_DATA);
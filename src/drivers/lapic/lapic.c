@@ -0,0 +1,153 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2026, k4m1 <me@k4m1.net>
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+ 
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+ 
+ 3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <cpu/common.h>
+#include <mm/paging.h>
+
+#include <drivers/device.h>
+#include <drivers/lapic/lapic.h>
+
+#include <interrupts/idt.h>
+
+#include <sys/profile.h>
+
+#include <time/clock.h>
+#include <time/tick.h>
+
+lapic_device *local_apic = NULL;
+
+void __attribute__((section(".rom_int_handler"), interrupt)) lapic_timer_int_handler(int_stack_frame *frame) {
+    profile_interrupted(frame->rip);
+    tick_handle_interrupt();
+    lapic_eoi();
+}
+
+// Spurious interrupts are not to be acknowledged
+void __attribute__((section(".rom_int_handler"), interrupt)) lapic_spurious_int_handler(int_stack_frame *frame __attribute__((unused))) {
+}
+
+/* Find out timer rate. Hypervisors may tell it, otherwise count 
+ * against TSC for a while.
+ *
+ * @return uint64_t timer rate in kHz, 0 if timer doesn't count
+ */
+static uint64_t lapic_timer_khz(void) {
+    uint64_t khz = cpuid_hypervisor_timing().ebx;
+    if (khz) {
+        return khz;
+    }
+    lapic_write(lapic_reg_lvt_timer, (LAPIC_LVT_MASKED | LAPIC_TIMER_VECTOR));
+    lapic_write(lapic_reg_timer_initial, 0xFFFFFFFF);
+    udelay(LAPIC_CALIBRATE_US);
+    uint32_t elapsed = (0xFFFFFFFF - lapic_read(lapic_reg_timer_current));
+    lapic_write(lapic_reg_timer_initial, 0);
+    return ((uint64_t)elapsed * 1000) / LAPIC_CALIBRATE_US;
+}
+
+/* Initialise local apic of boot cpu in virtual wire mode, so that 
+ * 8259 interrupts keep coming in through LINT0, and find out how 
+ * fast the timer counts.
+ *
+ * @param device *dev -- device, device_data is lapic_device
+ * @return enum DEVICE_STATUS
+ */
+enum DEVICE_STATUS lapic_init(device *dev) {
+    if ((cpuid(CPUID_FEATURES, 0).edx & CPUID_FEATURES_EDX_APIC) == 0) {
+        return status_not_present;
+    }
+    lapic_device *lapic = dev->device_data;
+    uint64_t msr = rdmsr(LAPIC_BASE_MSR);
+    lapic->base = (volatile uint8_t *)(msr & LAPIC_BASE_MASK);
+    if (map_address((void *)lapic->base, 0x1000) == false) {
+        return status_faulty;
+    }
+    wrmsr(LAPIC_BASE_MSR, (msr | LAPIC_BASE_MSR_ENABLE));
+    local_apic = lapic;
+
+    add_interrupt_handler(LAPIC_SPURIOUS_VECTOR, (uint64_t)lapic_spurious_int_handler);
+    add_interrupt_handler(LAPIC_TIMER_VECTOR, (uint64_t)lapic_timer_int_handler);
+
+    lapic_write(lapic_reg_tpr, 0);
+    lapic_write(lapic_reg_svr, (LAPIC_SVR_ENABLE | LAPIC_SPURIOUS_VECTOR));
+    lapic_write(lapic_reg_lvt_lint0, LAPIC_LVT_EXTINT);
+    lapic_write(lapic_reg_lvt_lint1, LAPIC_LVT_NMI);
+    lapic_write(lapic_reg_lvt_error, LAPIC_LVT_MASKED);
+    lapic_write(lapic_reg_timer_divide, LAPIC_TIMER_DIVIDE_1);
+    lapic->id = (lapic_read(lapic_reg_id) >> 24);
+
+    lapic->timer_khz = lapic_timer_khz();
+    if (lapic->timer_khz == 0) {
+        local_apic = NULL;
+        return status_faulty;
+    }
+    lapic_write(lapic_reg_lvt_timer, (LAPIC_TIMER_ONESHOT | LAPIC_TIMER_VECTOR));
+    return status_initialised;
+}
+
+/* Software enable local apic of an AP so that it takes fixed IPIs,
+ * LVT entries stay masked as INIT left them
+ */
+void lapic_ap_init(void) {
+    lapic_write(lapic_reg_tpr, 0);
+    lapic_write(lapic_reg_svr, (LAPIC_SVR_ENABLE | LAPIC_SPURIOUS_VECTOR));
+}
+
+/* Fire timer interrupt once after given amount of timer counts
+ *
+ * @param uint32_t count -- counts until interrupt, 0 stops timer
+ */
+void __attribute__((no_caller_saved_registers)) lapic_timer_oneshot(uint32_t count) {
+    lapic_write(lapic_reg_timer_initial, count);
+}
+
+/* Send inter-processor interrupt and wait for it to be accepted
+ *
+ * @param uint32_t apic_id -- destination, unused with shorthands
+ * @param uint32_t icr     -- low half of interrupt command register
+ * @return bool true if IPI was sent
+ */
+bool lapic_send_ipi(uint32_t apic_id, uint32_t icr) {
+    lapic_write(lapic_reg_esr, 0);
+    lapic_write(lapic_reg_icr_hi, (apic_id << 24));
+    lapic_write(lapic_reg_icr_lo, icr);
+    uint64_t deadline = deadline_us(LAPIC_IPI_TIMEOUT_US);
+    while (lapic_read(lapic_reg_icr_lo) & LAPIC_ICR_PENDING) {
+        if (deadline_passed(deadline)) {
+            return false;
+        }
+        cpu_relax();
+    }
+    return true;
+}
@@ -213,16 +213,19 @@ static const char *pci_get_dev_type_subclass_str(pci_device_data *dev) {
  * @param uint8_t device_count -- Amount of devices we have
  */
 void pci_print_devtree(device **pci_device_array, uint8_t count) {
+    if (blog_enabled(log_debug) == false) {
+        return;
+    }
     for (uint8_t off = 0; off < count; off++) {
         pci_device_data *dev = pci_device_array[off]->device_data;
-        blogf("PCI @ %04x:%04x:%04x: %s %s controller\n",
+        blogf_debug("PCI @ %04x:%04x:%04x: %s %s controller\n",
             dev->address.bus, 
             dev->address.device, dev->address.function,
             pci_get_dev_type_subclass_str(dev),
             pci_get_dev_type_class_str(dev)
         );
         if (dev->bist_executed) {
-            blog(" --> Self test executed\n");
+            blog_debug(" --> Self test executed\n");
         }
     }
 }
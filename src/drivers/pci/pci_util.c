@@ -31,6 +31,7 @@
  */
 
 #include <sys/io.h>
+#include <sys/spinlock.h>
 
 #include <drivers/device.h>
 #include <drivers/pci/pci.h>
@@ -39,6 +40,10 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+// Address and data port pair is shared by everyone, keep other cpus
+// from moving address under us
+static spinlock pci_config_lock = SPINLOCK_INIT;
+
 /* Read PCI Configuration dword with given address
  *
  * @param pci_config_address *addr -- PCI configuration address to read
@@ -46,10 +51,14 @@
  * @return uint32_t configuration word we received
  */
 uint32_t pci_read_config(pci_config_address *addr, uint8_t offset) {
-    addr->offset = offset;
-    outl(to_uint32_t(addr), pci_config_port);
-    addr->offset = 0;
-    return inl(pci_data_port);
+    bool int_enabled = spin_lock_irqsave(&pci_config_lock);
+    // Caller's address may be shared by other cpus, use a copy
+    pci_config_address target = *addr;
+    target.offset = offset;
+    outl(to_uint32_t(&target), pci_config_port);
+    uint32_t ret = inl(pci_data_port);
+    spin_unlock_irqrestore(&pci_config_lock, int_enabled);
+    return ret;
 }
 
 /* Write PCI Configuration dword with given address
@@ -59,10 +68,12 @@ uint32_t pci_read_config(pci_config_address *addr, uint8_t offset) {
  * @param uint32_t data            -- configuration dword to write 
  */
 void pci_write_config(pci_config_address *addr, uint8_t offset, uint32_t data) {
-    addr->offset = offset;
-    outl(to_uint32_t(addr), pci_config_port);
+    bool int_enabled = spin_lock_irqsave(&pci_config_lock);
+    pci_config_address target = *addr;
+    target.offset = offset;
+    outl(to_uint32_t(&target), pci_config_port);
     outl(data, pci_data_port);
-    addr->offset = 0;
+    spin_unlock_irqrestore(&pci_config_lock, int_enabled);
 }
 
 /* Start device self test if it's supported
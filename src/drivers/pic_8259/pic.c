@@ -31,10 +31,13 @@
  */
 
 #include <sys/io.h>
+#include <sys/spinlock.h>
 
 #include <drivers/device.h>
 #include <drivers/pic_8259/pic.h>
 
+#include <time/clock.h>
+
 #include <stdbool.h>
 #include <stdint.h>
 
@@ -47,6 +50,10 @@ pic_icw3_primary pic_picw3 = {0};
 pic_icw3_secondary pic_sicw3 = {0};
 pic_icw4 pic_current_icw4 = {0};
 
+// Guards shadow registers above and read-modify-write of pic 
+// registers, any cpu may be masking lines
+static spinlock pic_lock = SPINLOCK_INIT;
+
 /* Helper to send control words to interrupt controller(s)
  *
  * @param uint16_t port -- which pic we're talking to
@@ -54,7 +61,7 @@ pic_icw4 pic_current_icw4 = {0};
  */
 static inline void pic_send_cmd(uint16_t port, uint8_t *cw) {
     outb(*cw, port);
-    iodelay(50);
+    udelay(PIC_IO_DELAY_US);
 }
 
 /* Send data to programmable interrupt controller
@@ -64,7 +71,7 @@ static inline void pic_send_cmd(uint16_t port, uint8_t *cw) {
  */
 static inline void pic_send_data(uint16_t port, uint8_t *ow) {
     outb(*ow, port+1);
-    iodelay(50);
+    udelay(PIC_IO_DELAY_US);
 }
 
 /* Read data (mask) from programmable_interrupt_controller
@@ -94,6 +101,7 @@ void __attribute__((no_caller_saved_registers)) pic_send_eoi(uint8_t irq) {
  */
 enum DEVICE_STATUS pic_initialize(device *dev) {
     pic_full_configuration *pic_config = (pic_full_configuration *)dev->device_data;
+    bool int_enabled = spin_lock_irqsave(&pic_lock);
 
     pic_current_icw1.icw4_needed = 1;
     pic_current_icw1.icw_1 = 1;
@@ -146,6 +154,7 @@ enum DEVICE_STATUS pic_initialize(device *dev) {
     outb((uint8_t)tbit, 0x4d0);
     outb(((uint8_t)(tbit >> 8)), 0x4d1);
 
+    spin_unlock_irqrestore(&pic_lock, int_enabled);
     return status_initialised;
 }
 
@@ -155,11 +164,13 @@ enum DEVICE_STATUS pic_initialize(device *dev) {
  */
 void pic_mask_irq(uint8_t line) {
     uint16_t port = (line < 8) ? PIC_PRIMARY_PORT : PIC_SECONDARY_PORT;
-    line = line ? (line - 8) : (port == PIC_PRIMARY_PORT);
+    line = (line < 8) ? line : line-8;
 
-    uint8_t v = pic_get_mask(line);
+    bool int_enabled = spin_lock_irqsave(&pic_lock);
+    uint8_t v = pic_get_mask(port);
     v |= (1 << line);
-    outb(v, port);
+    pic_send_data(port, &v);
+    spin_unlock_irqrestore(&pic_lock, int_enabled);
 }
 
 /* Unmask irq line
@@ -170,9 +181,11 @@ void pic_unmask_irq(uint8_t line) {
     uint16_t port = (line < 8) ? PIC_PRIMARY_PORT : PIC_SECONDARY_PORT;
     line = (line < 8) ? line : line-8;
 
+    bool int_enabled = spin_lock_irqsave(&pic_lock);
     uint8_t v = pic_get_mask(port);
     v &= ~(1 << line);
     pic_send_data(port, &v);
+    spin_unlock_irqrestore(&pic_lock, int_enabled);
 }
 
 /* Read irq register from the programmable interrupt controller.
@@ -181,10 +194,12 @@ void pic_unmask_irq(uint8_t line) {
  * @return uint16_t irq
  */
 uint16_t pic_read_irq(pic_ocw3 *ocw) {
+    bool int_enabled = spin_lock_irqsave(&pic_lock);
     pic_send_cmd(PIC_PRIMARY_PORT, (uint8_t *)ocw);
     pic_send_cmd(PIC_SECONDARY_PORT, (uint8_t *)ocw);
     uint16_t ret = inb(PIC_SECONDARY_PORT) << 8;
     ret |= inb(PIC_PRIMARY_PORT);
+    spin_unlock_irqrestore(&pic_lock, int_enabled);
     return ret;
 }
 
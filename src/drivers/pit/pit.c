@@ -39,13 +39,116 @@
 
 #include <drivers/pic_8259/pic.h>
 
+#include <cpu/common.h>
+
 #include <interrupts/idt.h>
 
+#include <sys/profile.h>
+
+#include <time/tick.h>
+
 void __attribute__((section(".rom_int_handler"), interrupt)) pit_int_handler(int_stack_frame *frame) {
+    profile_interrupted(frame->rip);
+    tick_handle_interrupt();
     pic_send_eoi(0);
+}
+
+
+/* Count PIT channel 2 down from given value and measure how many
+ * TSC ticks that took. Speaker stays off.
+ *
+ * @param uint16_t count -- PIT ticks to wait for
+ * @return uint64_t tsc ticks elapsed, or 0 if channel 2 never fired
+ */
+uint64_t pit_measure_tsc(uint16_t count) {
+    pit_command cmd;
+    uint8_t ctl = inb(pit_ch2_control_port);
+
+    // Gate low while we program the count, speaker off
+    ctl &= ~(PIT_CH2_GATE | PIT_CH2_SPEAKER);
+    outb(ctl, pit_ch2_control_port);
+
+    cmd.access_mode      = lo_and_hi_byte;
+    cmd.binary_mode      = binary;
+    cmd.operating_mode   = int_on_terminal_count;
+    cmd.selected_channel = channel_2;
+    pit_write_command(&cmd);
+    outb((uint8_t)(count & 0xFF), pit_channel_2_port);
+    outb((uint8_t)(count >> 8), pit_channel_2_port);
+
+    // Counting starts when gate goes high, output goes high at
+    // terminal count.
+    outb((ctl | PIT_CH2_GATE), pit_ch2_control_port);
+    uint64_t start = rdtsc();
+    for (uint32_t spin = 0; spin < 0x1000000; spin++) {
+        if (inb(pit_ch2_control_port) & PIT_CH2_OUT) {
+            uint64_t end = rdtsc();
+            outb(ctl, pit_ch2_control_port);
+            return (end - start);
+        }
+    }
+    outb(ctl, pit_ch2_control_port);
+    return 0;
+}
+
+/* Set PIT channel 2 counting down from 65536 over and over, so that
+ * it can be read as a free running 16-bit counter. Speaker stays off.
+ */
+void pit_ch2_free_run(void) {
+    pit_command cmd;
+    uint8_t ctl = inb(pit_ch2_control_port);
+
+    ctl &= ~(PIT_CH2_GATE | PIT_CH2_SPEAKER);
+    outb(ctl, pit_ch2_control_port);
+
+    cmd.access_mode      = lo_and_hi_byte;
+    cmd.binary_mode      = binary;
+    cmd.operating_mode   = rate_generator;
+    cmd.selected_channel = channel_2;
+    pit_write_command(&cmd);
+    outb(0x00, pit_channel_2_port);
+    outb(0x00, pit_channel_2_port);
 
+    outb((ctl | PIT_CH2_GATE), pit_ch2_control_port);
 }
 
+/* Read current channel 2 count
+ *
+ * @return uint16_t count, counts down
+ */
+uint16_t pit_ch2_read(void) {
+    pit_command cmd = {0};
+    cmd.access_mode      = latch_count_value;
+    cmd.selected_channel = channel_2;
+    pit_write_command(&cmd);
+
+    uint16_t lo = inb(pit_channel_2_port);
+    uint16_t hi = inb(pit_channel_2_port);
+    return ((hi << 8) | lo);
+}
+
+/* Switch channel 0 to interrupt on terminal count, it then stays 
+ * quiet until pit_oneshot() gives it something to count.
+ */
+void pit_oneshot_mode(void) {
+    pit_command cmd;
+
+    cmd.access_mode      = lo_and_hi_byte;
+    cmd.binary_mode      = binary;
+    cmd.operating_mode   = int_on_terminal_count;
+    cmd.selected_channel = channel_0;
+    pit_write_command(&cmd);
+}
+
+/* Fire IRQ 0 once after given amount of PIT ticks. Writing low byte 
+ * stops the count in progress, high byte starts the new one.
+ *
+ * @param uint16_t count -- PIT ticks until interrupt
+ */
+void __attribute__((no_caller_saved_registers)) pit_oneshot(uint16_t count) {
+    outb((uint8_t)(count & 0xFF), pit_channel_0_port);
+    outb((uint8_t)(count >> 8), pit_channel_0_port);
+}
 
 /* Setup PIT with default init.
  *
@@ -62,8 +165,9 @@ enum DEVICE_STATUS pit_init(device *dev __attribute__((unused))) {
     cmd.selected_channel = channel_0;
 
     pit_write_command(&cmd);
-    outb(0x00, 0x40);
-    outb(0x10, 0x40);
+    uint16_t reload = (PIT_FREQUENCY_HZ / PIT_TICK_HZ);
+    outb((uint8_t)(reload & 0xFF), pit_channel_0_port);
+    outb((uint8_t)(reload >> 8), pit_channel_0_port);
 
     add_interrupt_handler(0x20, (uint64_t)pit_int_handler);
     
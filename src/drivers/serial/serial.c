@@ -32,18 +32,123 @@
  */
 
 #include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
 #include <sys/io.h>
 
+#include <cpu/common.h>
+
 #include <drivers/device.h>
 #include <drivers/serial/serial.h>
+#include <drivers/pic_8259/pic.h>
+#include <drivers/cmos/cmos.h>
+
+#include <interrupts/idt.h>
+
+#include <mainboards/config.h>
+
+#include <time/clock.h>
 
 #include <stdbool.h>
 
-/* interrupt handler for serial port driver
+// uarts we've initialised, serial_tx() only gets the port so this
+// is how we find out how deep the FIFO behind it is.
+static serial_uart_device *serial_uarts[SERIAL_MAX_UARTS];
+
+/* Find an initialised uart by its port
+ *
+ * @param unsigned short port -- port we're about to work with
+ * @return serial_uart_device pointer or NULL for unknown ports
+ */
+static serial_uart_device *serial_find_uart(unsigned short port) {
+    for (int i = 0; i < SERIAL_MAX_UARTS; i++) {
+        if (serial_uarts[i] && (serial_uarts[i]->base_port == port)) {
+            return serial_uarts[i];
+        }
+    }
+    return NULL;
+}
+
+/* Keep track of an initialised uart
+ *
+ * @param serial_uart_device *sdev -- uart to keep track of
+ */
+static void serial_register_uart(serial_uart_device *sdev) {
+    for (int i = 0; i < SERIAL_MAX_UARTS; i++) {
+        if (!serial_uarts[i] || (serial_uarts[i]->base_port == sdev->base_port)) {
+            serial_uarts[i] = sdev;
+            return;
+        }
+    }
+}
+
+/* Move everything the uart has received into rx ring, counting overruns
+ * and bytes we had no room for.
+ *
+ * @param serial_uart_device *sdev -- uart to service
+ */
+static void serial_irq_rx(serial_uart_device *sdev) {
+    serial_line_status stat;
+    stat.raw = serial_get_line_status(sdev->base_port);
+    while (stat.data_ready) {
+        if (stat.overrun_err) {
+            sdev->rx_overruns++;
+        }
+        uint8_t c = inb(SERIAL_DATA(sdev->base_port));
+        if (ringbuf_put(&sdev->rx_ring, c) == false) {
+            sdev->rx_dropped++;
+        }
+        stat.raw = serial_get_line_status(sdev->base_port);
+    }
+    if (stat.overrun_err) {
+        sdev->rx_overruns++;
+    }
+}
+
+/* Refill uart FIFO from tx ring, and stop THR-empty interrupts once
+ * there's nothing left to send.
  *
+ * @param serial_uart_device *sdev -- uart to service
  */
-void __attribute__((section(".rom_int_handler"))) serial_int_handler(void) {
+static void serial_irq_tx(serial_uart_device *sdev) {
+    uint8_t c;
+    for (unsigned char room = sdev->fifo_depth; room; room--) {
+        if (ringbuf_get(&sdev->tx_ring, &c) == false) {
+            serial_interrupts_enable(sdev->base_port, 
+                    (SERIAL_IER_RX_AVAIL | SERIAL_IER_LINE_STATUS));
+            return;
+        }
+        outb(c, SERIAL_DATA(sdev->base_port));
+    }
+}
 
+/* interrupt handler for serial port driver
+ *
+ */
+void __attribute__((section(".rom_int_handler"), interrupt)) serial_int_handler(int_stack_frame *frame __attribute__((unused))) {
+    for (int i = 0; i < SERIAL_MAX_UARTS; i++) {
+        serial_uart_device *sdev = serial_uarts[i];
+        if (!sdev || !sdev->irq_enabled) {
+            continue;
+        }
+        unsigned char iir;
+        while (((iir = serial_get_int_id(sdev->base_port)) & 1) == 0) {
+            switch ((iir >> 1) & 0x07) {
+            case (SERIAL_IIR_LINE_STATUS):
+            case (SERIAL_IIR_RX_AVAIL):
+            case (SERIAL_IIR_RX_TIMEOUT):
+                serial_irq_rx(sdev);
+                break;
+            case (SERIAL_IIR_THR_EMPTY):
+                serial_irq_tx(sdev);
+                break;
+            default:
+                serial_get_modem_status(sdev->base_port);
+                break;
+            }
+        }
+    }
+    pic_send_eoi(SERIAL_COM_PRIMARY_IRQ);
 }
 
 /* Poll for serial port until line is empty.
@@ -52,17 +157,160 @@ void __attribute__((section(".rom_int_handler"))) serial_int_handler(void) {
  * @return 0 when line is empty, or non-zero if timed out.
  */
 unsigned char serial_wait_for_tx_empty(unsigned short port) {
-    for (int i = 0; i < 50000; i++) {
+    uint64_t deadline = deadline_us(SERIAL_POLL_TIMEOUT_US);
+    do {
         serial_line_status stat = {0};
         stat.raw = serial_get_line_status(port);
         if (stat.tx_ready) {
             return 0;
         }
-        asm volatile("nop":::"memory");
-    }
+        cpu_relax();
+    } while (!deadline_passed(deadline));
+    return 1;
+}
+
+/* Poll for serial port until we've received something.
+ *
+ * @param unsigned short port -- Port to wait for
+ * @return 0 when data is ready, or non-zero if timed out.
+ */
+static unsigned char serial_wait_for_rx_ready(unsigned short port) {
+    uint64_t deadline = deadline_us(SERIAL_POLL_TIMEOUT_US);
+    do {
+        serial_line_status stat = {0};
+        stat.raw = serial_get_line_status(port);
+        if (stat.data_ready) {
+            return 0;
+        }
+        cpu_relax();
+    } while (!deadline_passed(deadline));
     return 1;
 }
 
+/* Detect what kind of FIFO the uart has, enable it, and clear it.
+ *
+ * The 64-byte enable bit of 16750 can only be written while DLAB is
+ * set, other uarts ignore it. Interrupt identification register then
+ * tells us what we got:
+ *
+ *  bits 7:6 = 00 -- no FIFO (8250/16450)
+ *  bits 7:6 = 10 -- FIFO enabled but unusable (16550)
+ *  bits 7:6 = 11 -- FIFO enabled and working (16550A), bit 5 set if 64 bytes
+ *
+ * @param serial_uart_device *sdev -- uart to probe, base_port must be set
+ * @return unsigned char amount of bytes we can push per THR-empty wait
+ */
+unsigned char serial_init_fifo(serial_uart_device *sdev) {
+    unsigned short port = sdev->base_port;
+    unsigned char lcr = inb(SERIAL_LCR(port));
+
+    outb((lcr | 0x80), SERIAL_LCR(port));
+    outb((COM_DEFAULT_FIFO_CTL | SERIAL_FCR_64BYTE), SERIAL_FIFO_CTRL(port));
+    outb(lcr, SERIAL_LCR(port));
+
+    unsigned char iir = serial_get_int_id(port);
+    switch (iir & 0xC0) {
+    case (0xC0):
+        if (iir & 0x20) {
+            sdev->type = uart_16750;
+            sdev->fifo_depth = 64;
+            sdev->fifo_control = (COM_DEFAULT_FIFO_CTL | SERIAL_FCR_64BYTE);
+        } else {
+            sdev->type = uart_16550a;
+            sdev->fifo_depth = 16;
+            sdev->fifo_control = COM_DEFAULT_FIFO_CTL;
+        }
+        break;
+    case (0x80):
+        sdev->type = uart_16550;
+        sdev->fifo_depth = 1;
+        sdev->fifo_control = 0;
+        outb(0, SERIAL_FIFO_CTRL(port));
+        break;
+    default:
+        sdev->type = uart_8250;
+        sdev->fifo_depth = 1;
+        sdev->fifo_control = 0;
+        break;
+    }
+    return sdev->fifo_depth;
+}
+
+static void serial_tx_drain(serial_uart_device *sdev);
+
+// baud rates selectable with CMOS byte cmos_addr_serial_baud, 0 means
+// 'not set, use build time default'
+static const uint32_t serial_cmos_baud_table[] = {
+    0, 9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600
+};
+
+/* Figure out which baud rate user wants. Mainboard configuration (fw_cfg
+ * on qemu) goes first, then CMOS, then whatever we were built with.
+ *
+ * @return uint32_t baud rate
+ */
+static uint32_t serial_configured_baudrate(void) {
+    uint32_t baud = mainboard_uart_baudrate();
+    if (baud) {
+        return baud;
+    }
+    uint8_t idx = cmos_read_raw(cmos_addr_serial_baud);
+    if (idx < (sizeof(serial_cmos_baud_table) / sizeof(uint32_t))) {
+        baud = serial_cmos_baud_table[idx];
+    }
+    if (baud) {
+        return baud;
+    }
+    return CONFIG_SERIAL_BAUDRATE;
+}
+
+/* Change baud rate of an initialised uart. Anything still waiting to
+ * be sent goes out at the old rate first.
+ *
+ * @param device *dev   -- uart device structure
+ * @param uint32_t baud -- new baud rate, CONFIG_SERIAL_BASE_BAUD must
+ *                         be divisible by it
+ * @return bool true on success, false if baud rate can't be programmed
+ */
+bool serial_set_baud(device *dev, uint32_t baud) {
+    serial_uart_device *sdev = dev->device_data;
+    if ((baud == 0) || (baud > CONFIG_SERIAL_BASE_BAUD) || 
+        (CONFIG_SERIAL_BASE_BAUD % baud)) {
+        return false;
+    }
+    uint32_t brd = (CONFIG_SERIAL_BASE_BAUD / baud);
+    if (brd > 0xFFFF) {
+        return false;
+    }
+
+    bool int_enabled = interrupts_enabled();
+    cli();
+    if (sdev->irq_enabled) {
+        serial_tx_drain(sdev);
+    }
+    // wait for transmitter to be completely empty, not just the THR,
+    // or last bytes get garbled. That's FIFO + shift register worth
+    // of bytes at the old rate, give it twice that.
+    uint32_t drain_us = (((sdev->fifo_depth + 1) * serial_bits_per_byte(sdev->line_control) * 
+                2000000) / sdev->baudrate);
+    uint64_t deadline = deadline_us(drain_us);
+    do {
+        serial_line_status stat = {0};
+        stat.raw = serial_get_line_status(sdev->base_port);
+        if (stat.tx_empty) {
+            break;
+        }
+        cpu_relax();
+    } while (!deadline_passed(deadline));
+    serial_set_baudrate(sdev->base_port, (unsigned short)brd);
+    sdev->baudrate_divisor = (unsigned short)brd;
+    sdev->baudrate = baud;
+    if (int_enabled) {
+        sti();
+    }
+    return true;
+}
+
 /* Initialise a serial port for comms
  *
  * @param device *dev -- Pointer to device structure
@@ -76,36 +324,219 @@ enum DEVICE_STATUS serial_init_device(device *dev) {
     serial_set_baudrate(port, COM_DEFAULT_BRD);
     serial_set_linecontrol(port, COM_DEFAULT_LINE_CTL);
 
-    // Enable FIFO
-    outb(0x01, SERIAL_FIFO_CTRL(port));
-    outb(0x03, SERIAL_MCR(port));
-
     sdev->base_port = port;
     sdev->baudrate_divisor = COM_DEFAULT_BRD;
-    sdev->fifo_control = 0x01;
+    sdev->baudrate = CONFIG_SERIAL_BAUDRATE;
+    sdev->line_control = COM_DEFAULT_LINE_CTL;
+
+    serial_init_fifo(sdev);
+    outb(0x03, SERIAL_MCR(port));
+
+    serial_register_uart(sdev);
+    if (serial_set_baud(dev, serial_configured_baudrate()) == false) {
+        serial_set_baud(dev, CONFIG_SERIAL_BAUDRATE);
+    }
     return status_initialised;
 }
 
-/* Write a string over serial line
+/* Switch uart over to interrupt driven tx/rx. Interrupt controller
+ * must be initialised before calling this.
+ *
+ * @param device *dev -- uart device structure
+ * @return bool true on success
+ */
+bool serial_enable_irq(device *dev) {
+    serial_uart_device *sdev = dev->device_data;
+    if ((dev->status != status_initialised) || (sdev->base_port != SERIAL_COM_PRIMARY)) {
+        return false;
+    }
+    uint8_t *tx = malloc(SERIAL_TX_RING_SIZE);
+    if (!tx) {
+        return false;
+    }
+    uint8_t *rx = malloc(SERIAL_RX_RING_SIZE);
+    if (!rx) {
+        free(tx);
+        return false;
+    }
+    ringbuf_init(&sdev->tx_ring, tx, SERIAL_TX_RING_SIZE);
+    ringbuf_init(&sdev->rx_ring, rx, SERIAL_RX_RING_SIZE);
+
+    add_interrupt_handler(SERIAL_COM_PRIMARY_VECTOR, (uint64_t)serial_int_handler);
+    outb((SERIAL_MCR_DTR | SERIAL_MCR_RTS | SERIAL_MCR_OUT2), SERIAL_MCR(sdev->base_port));
+    sdev->irq_enabled = true;
+    serial_interrupts_enable(sdev->base_port, (SERIAL_IER_RX_AVAIL | SERIAL_IER_LINE_STATUS));
+    pic_unmask_irq(SERIAL_COM_PRIMARY_IRQ);
+    return true;
+}
+
+/* Print overflow, dropped byte and overrun counters of a uart
+ *
+ * @param device *dev -- uart device structure
+ */
+void serial_print_stats(device *dev) {
+    serial_uart_device *sdev = dev->device_data;
+    blogf("%s: tx polled %d, rx dropped %d, rx overruns %d\n", dev->device_name,
+        sdev->tx_polled, sdev->rx_dropped, sdev->rx_overruns);
+}
+
+/* Write bytes straight to the uart, waiting for THR-empty once per
+ * full FIFO.
  *
  * @param unsigned short port -- Device to write to
- * @param const unsigned char *msg  -- Absolute address to string to write
+ * @param unsigned char depth -- FIFO depth of the device
+ * @param const char *msg     -- bytes to write
+ * @param size_t len          -- amount of bytes to write
+ * @param bool raw            -- send LF as is instead of CRLF
  * @return amount of bytes transmitted
  */
-size_t serial_tx(unsigned short port, const char *msg, size_t len) {
-    size_t i;
+static size_t serial_tx_poll(unsigned short port, unsigned char depth, const char *msg, size_t len,
+        bool raw) {
+    bool cr_sent = false;
+    size_t i = 0;
 
-    for (i = 0; i < len; i++) {
+    while (i < len) {
         do { } while (serial_wait_for_tx_empty(port));
-        if (msg[i] == '\n') {
-            outb('\r', port);
-            do { } while (serial_wait_for_tx_empty(port));
+        for (unsigned char room = depth; room && (i < len); room--) {
+            if ((msg[i] == '\n') && !cr_sent && !raw) {
+                outb('\r', port);
+                cr_sent = true;
+                continue;
+            }
+            outb(msg[i], port);
+            cr_sent = false;
+            i++;
+        }
+    }
+    return i;
+}
+
+/* Send whatever the irq handler hasn't sent yet by polling, used when
+ * we can't rely on interrupts.
+ *
+ * @param serial_uart_device *sdev -- uart to flush
+ */
+static void serial_tx_drain(serial_uart_device *sdev) {
+    uint8_t c;
+    while (ringbuf_empty(&sdev->tx_ring) == false) {
+        do { } while (serial_wait_for_tx_empty(sdev->base_port));
+        for (unsigned char room = sdev->fifo_depth; room; room--) {
+            if (ringbuf_get(&sdev->tx_ring, &c) == false) {
+                break;
+            }
+            outb(c, SERIAL_DATA(sdev->base_port));
+        }
+    }
+}
+
+/* Queue bytes for the irq handler to send, and make sure THR-empty
+ * interrupts are on. If tx ring fills up, whatever is queued goes out
+ * and the rest is sent by polling, log lines are never lost.
+ *
+ * @param serial_uart_device *sdev -- uart to write to
+ * @param const char *msg          -- bytes to write
+ * @param size_t len               -- amount of bytes to write
+ * @param bool raw                 -- send LF as is instead of CRLF
+ * @return amount of bytes queued or sent
+ */
+static size_t serial_tx_queue(serial_uart_device *sdev, const char *msg, size_t len, bool raw) {
+    size_t i = 0;
+    while (i < len) {
+        size_t run = 0;
+        while (((i + run) < len) && (raw || (msg[i + run] != '\n'))) {
+            run++;
+        }
+        size_t queued = ringbuf_write(&sdev->tx_ring, &msg[i], run);
+        i += queued;
+        if (queued != run) {
+            break;
+        }
+        if (i < len) {
+            if (ringbuf_free(&sdev->tx_ring) < 2) {
+                break;
+            }
+            ringbuf_write(&sdev->tx_ring, "\r\n", 2);
+            i++;
+        }
+    }
+    if (i < len) {
+        // Irq handler shares the ring, keep it out until we're done
+        bool int_enabled = interrupts_enabled();
+        cli();
+        serial_tx_drain(sdev);
+        sdev->tx_polled += (len - i);
+        i += serial_tx_poll(sdev->base_port, sdev->fifo_depth, &msg[i], (len - i), raw);
+        if (int_enabled) {
+            sti();
         }
-        outb(msg[i], port);
     }
+    serial_interrupts_enable(sdev->base_port, 
+            (SERIAL_IER_RX_AVAIL | SERIAL_IER_LINE_STATUS | SERIAL_IER_THR_EMPTY));
     return i;
 }
 
+/* Write a string over serial line
+ *
+ * With interrupts enabled we only queue the string and return, otherwise
+ * we wait for transmit holding register to become empty once, and then
+ * fill the whole FIFO before polling line status again.
+ *
+ * @param unsigned short port -- Device to write to
+ * @param const unsigned char *msg  -- Absolute address to string to write
+ * @param size_t len          -- amount of bytes to write
+ * @param bool raw            -- send LF as is instead of CRLF
+ * @return amount of bytes transmitted
+ */
+static size_t serial_tx_data(unsigned short port, const char *msg, size_t len, bool raw) {
+    serial_uart_device *sdev = serial_find_uart(port);
+    if (!sdev) {
+        return serial_tx_poll(port, 1, msg, len, raw);
+    }
+    if (sdev->irq_enabled) {
+        if (interrupts_enabled()) {
+            return serial_tx_queue(sdev, msg, len, raw);
+        }
+        serial_tx_drain(sdev);
+    }
+    return serial_tx_poll(port, sdev->fifo_depth, msg, len, raw);
+}
+
+/* Write a string over serial line, LF goes out as CRLF
+ *
+ * @param unsigned short port -- Device to write to
+ * @param const unsigned char *msg  -- Absolute address to string to write
+ * @param size_t len          -- amount of bytes to write
+ * @return amount of bytes transmitted
+ */
+size_t serial_tx(unsigned short port, const char *msg, size_t len) {
+    return serial_tx_data(port, msg, len, false);
+}
+
+/* Console sink write function for uarts
+ *
+ * @param device *dev     -- uart device structure
+ * @param const char *msg -- data to write
+ * @param size_t len      -- amount of bytes to write
+ * @return size_t bytes written
+ */
+size_t serial_console_write(device *dev, const char *msg, size_t len) {
+    serial_uart_device *sdev = dev->device_data;
+    return serial_tx(sdev->base_port, msg, len);
+}
+
+/* Console sink write function for uarts carrying binary log records,
+ * which may have 0x0A anywhere in them. Bytes go out as they are.
+ *
+ * @param device *dev     -- uart device structure
+ * @param const char *msg -- data to write
+ * @param size_t len      -- amount of bytes to write
+ * @return size_t bytes written
+ */
+size_t serial_console_write_raw(device *dev, const char *msg, size_t len) {
+    serial_uart_device *sdev = dev->device_data;
+    return serial_tx_data(sdev->base_port, msg, len, true);
+}
+
 /* Receive a string over serial line
  *
  * @param unsigned short port -- Device to read from
@@ -114,14 +545,37 @@ size_t serial_tx(unsigned short port, const char *msg, size_t len) {
  * @return amount of bytes received 
  */
 size_t serial_rx(unsigned short port, char *dst, const size_t size) {
-    size_t i;
-    for (i = 0; i < size; i++) {
-        while (serial_wait_for_tx_empty(port) != 0) {
-            continue;
+    serial_uart_device *sdev = serial_find_uart(port);
+    size_t i = 0;
+
+    if (sdev && sdev->irq_enabled) {
+        i = ringbuf_read(&sdev->rx_ring, dst, size);
+        if (interrupts_enabled()) {
+            return i;
+        }
+    }
+    for ( ; i < size; i++) {
+        if (serial_wait_for_rx_ready(port)) {
+            break;
         }
         dst[i] = inb(SERIAL_DATA(port));
     }
     return i;
 }
 
+/* Get amount of received bytes waiting to be read
+ *
+ * @param unsigned short port -- Device to check
+ * @return size_t bytes available without waiting
+ */
+size_t serial_rx_available(unsigned short port) {
+    serial_uart_device *sdev = serial_find_uart(port);
+    if (sdev && sdev->irq_enabled) {
+        return ringbuf_used(&sdev->rx_ring);
+    }
+    serial_line_status stat;
+    stat.raw = serial_get_line_status(port);
+    return stat.data_ready;
+}
+
 
@@ -0,0 +1,195 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2026, k4m1 <me@k4m1.net>
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+ 
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+ 
+ 3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <sys/io.h>
+
+#include <drivers/device.h>
+#include <drivers/vgatext/vgatext.h>
+
+// Four blank cells, for clearing 8 bytes at a time
+#define VGATEXT_BLANK_QWORD \
+    (((uint64_t)VGATEXT_BLANK << 48) | ((uint64_t)VGATEXT_BLANK << 32) | \
+     ((uint64_t)VGATEXT_BLANK << 16) | (uint64_t)VGATEXT_BLANK)
+
+// Row is 160 bytes, 20 qwords
+#define VGATEXT_ROW_QWORDS  ((VGATEXT_COLS * sizeof(uint16_t)) / sizeof(uint64_t))
+
+/* Write a crtc register
+ *
+ * @param unsigned short crtc -- crtc index port
+ * @param uint8_t reg         -- register to write
+ * @param uint8_t value       -- value to write
+ */
+static inline void vgatext_crtc_write(unsigned short crtc, uint8_t reg, uint8_t value) {
+    outb(reg, crtc);
+    outb(value, (crtc + 1));
+}
+
+/* Move hardware cursor to our cursor position
+ *
+ * @param vgatext_console *con -- console
+ */
+static void vgatext_update_cursor(vgatext_console *con) {
+    uint16_t cx = con->cx;
+    if (cx >= VGATEXT_COLS) {
+        cx = (VGATEXT_COLS - 1);
+    }
+    uint16_t pos = ((con->cy * VGATEXT_COLS) + cx);
+    vgatext_crtc_write(con->crtc, vga_crtc_cursor_hi, (uint8_t)(pos >> 8));
+    vgatext_crtc_write(con->crtc, vga_crtc_cursor_lo, (uint8_t)(pos & 0xFF));
+}
+
+/* Fill text rows with blanks
+ *
+ * @param vgatext_console *con -- console
+ * @param uint16_t row         -- first row to clear
+ * @param uint16_t count       -- amount of rows to clear
+ */
+static void vgatext_clear_rows(vgatext_console *con, uint16_t row, uint16_t count) {
+    volatile uint64_t *dst = (volatile uint64_t *)&con->buf[(row * VGATEXT_COLS)];
+    for (size_t i = 0; i < (count * VGATEXT_ROW_QWORDS); i++) {
+        dst[i] = VGATEXT_BLANK_QWORD;
+    }
+}
+
+/* Scroll screen up by one row, 8 bytes at a time
+ *
+ * @param vgatext_console *con -- console
+ */
+static void vgatext_scroll(vgatext_console *con) {
+    volatile uint64_t *dst = (volatile uint64_t *)con->buf;
+    volatile uint64_t *src = (volatile uint64_t *)&con->buf[VGATEXT_COLS];
+    for (size_t i = 0; i < ((VGATEXT_ROWS - 1) * VGATEXT_ROW_QWORDS); i++) {
+        dst[i] = src[i];
+    }
+    vgatext_clear_rows(con, (VGATEXT_ROWS - 1), 1);
+}
+
+/* Move cursor to start of next line, scrolling if needed
+ *
+ * @param vgatext_console *con -- console
+ */
+static void vgatext_newline(vgatext_console *con) {
+    con->cx = 0;
+    if ((con->cy + 1) < VGATEXT_ROWS) {
+        con->cy++;
+    } else {
+        vgatext_scroll(con);
+    }
+}
+
+/* Put character at cursor position and advance cursor. Wrapping is
+ * deferred until there's something to put on next line.
+ *
+ * @param vgatext_console *con -- console
+ * @param char c               -- character to draw
+ */
+static void vgatext_putc(vgatext_console *con, char c) {
+    if (con->cx >= VGATEXT_COLS) {
+        vgatext_newline(con);
+    }
+    con->buf[((con->cy * VGATEXT_COLS) + con->cx)] = 
+        ((VGATEXT_ATTR << 8) | (unsigned char)c);
+    con->cx++;
+}
+
+/* Initialise VGA text console, checks that there's memory behind
+ * the text buffer and clears the screen.
+ *
+ * @param device *dev -- vgatext device structure
+ * @return status_initialised if text buffer is present
+ */
+enum DEVICE_STATUS vgatext_init(device *dev) {
+    vgatext_console *con = dev->device_data;
+    con->buf = (volatile uint16_t *)VGATEXT_BUFFER;
+
+    // Nothing decodes the legacy window if there's no vga, reads
+    // then float to all ones.
+    uint16_t old = con->buf[0];
+    con->buf[0] = 0x5AA5;
+    bool present = (con->buf[0] == 0x5AA5);
+    con->buf[0] = old;
+    if (!present) {
+        return status_not_present;
+    }
+
+    if (inb(VGA_MISC_OUT_RD) & VGA_MISC_IO_COLOUR) {
+        con->crtc = VGA_CRTC_COLOUR;
+    } else {
+        con->crtc = VGA_CRTC_MONO;
+    }
+    // Underline cursor, scanlines 14-15
+    vgatext_crtc_write(con->crtc, vga_crtc_cursor_start, 14);
+    vgatext_crtc_write(con->crtc, vga_crtc_cursor_end, 15);
+
+    con->cx = 0;
+    con->cy = 0;
+    vgatext_clear_rows(con, 0, VGATEXT_ROWS);
+    vgatext_update_cursor(con);
+    return status_initialised;
+}
+
+/* Console sink write function for VGA text console. Hardware
+ * cursor is moved once per call, not per character.
+ *
+ * @param device *dev     -- vgatext device structure
+ * @param const char *msg -- data to write
+ * @param size_t len      -- amount of bytes to write
+ * @return size_t bytes written
+ */
+size_t vgatext_console_write(device *dev, const char *msg, size_t len) {
+    vgatext_console *con = dev->device_data;
+
+    for (size_t i = 0; i < len; i++) {
+        switch (msg[i]) {
+        case '\n':
+            vgatext_newline(con);
+            break;
+        case '\r':
+            con->cx = 0;
+            break;
+        case '\t':
+            do {
+                vgatext_putc(con, ' ');
+            } while ((con->cx % 8) && (con->cx < VGATEXT_COLS));
+            break;
+        default:
+            vgatext_putc(con, msg[i]);
+            break;
+        }
+    }
+    vgatext_update_cursor(con);
+    return len;
+}
@@ -0,0 +1,154 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2026, k4m1 <me@k4m1.net>
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+ 
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+ 
+ 3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __TINY_CONSOLE_BINLOG_H__
+#define __TINY_CONSOLE_BINLOG_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <console/console.h>
+
+/* Binary log records
+ *
+ * Instead of formatting text on target, level tagged blogf_X() calls
+ * emit a record that refers to format string by its offset in the 
+ * .blog_fmt section of tinybios.elf. That section is never loaded, 
+ * tools/blogdecode.py reads the strings back from the ELF and does 
+ * the formatting on host.
+ *
+ * Record layout, integers are unsigned LEB128:
+ *
+ *  BLOG_BIN_MAGIC      -- 0xFF, never appears in text output
+ *  uint8_t level       -- enum LOG_LEVEL
+ *  fmt                 -- offset of format string in .blog_fmt
+ *  argc                -- amount of arguments
+ *  strmask             -- bit N set if argument N is a string
+ *  args                -- integers as LEB128, strings as NUL terminated
+ *                         bytes truncated to BLOG_BIN_MAX_STR
+ *
+ * Plain text from blog() and co is passed through as is, so decoder
+ * just needs to look for the magic byte.
+ */
+#define BLOG_BIN_MAGIC      0xFF
+#define BLOG_BIN_MAX_ARGS   16
+#define BLOG_BIN_MAX_STR    64
+
+/* Single argument for a binary log record
+ *
+ * @member uint64_t value -- argument value, or pointer to string
+ * @member bool is_str    -- argument is a string
+ */
+typedef struct {
+    uint64_t value;
+    bool is_str;
+} blog_arg;
+
+#define BLOG_ARG(x) { .value = (uint64_t)(x), \
+    .is_str = _Generic((x), char *: true, const char *: true, default: false) }
+
+#define BLOG_ARGS_1(a)       BLOG_ARG(a)
+#define BLOG_ARGS_2(a, ...)  BLOG_ARG(a), BLOG_ARGS_1(__VA_ARGS__)
+#define BLOG_ARGS_3(a, ...)  BLOG_ARG(a), BLOG_ARGS_2(__VA_ARGS__)
+#define BLOG_ARGS_4(a, ...)  BLOG_ARG(a), BLOG_ARGS_3(__VA_ARGS__)
+#define BLOG_ARGS_5(a, ...)  BLOG_ARG(a), BLOG_ARGS_4(__VA_ARGS__)
+#define BLOG_ARGS_6(a, ...)  BLOG_ARG(a), BLOG_ARGS_5(__VA_ARGS__)
+#define BLOG_ARGS_7(a, ...)  BLOG_ARG(a), BLOG_ARGS_6(__VA_ARGS__)
+#define BLOG_ARGS_8(a, ...)  BLOG_ARG(a), BLOG_ARGS_7(__VA_ARGS__)
+#define BLOG_ARGS_9(a, ...)  BLOG_ARG(a), BLOG_ARGS_8(__VA_ARGS__)
+#define BLOG_ARGS_10(a, ...) BLOG_ARG(a), BLOG_ARGS_9(__VA_ARGS__)
+#define BLOG_ARGS_11(a, ...) BLOG_ARG(a), BLOG_ARGS_10(__VA_ARGS__)
+#define BLOG_ARGS_12(a, ...) BLOG_ARG(a), BLOG_ARGS_11(__VA_ARGS__)
+#define BLOG_ARGS_13(a, ...) BLOG_ARG(a), BLOG_ARGS_12(__VA_ARGS__)
+#define BLOG_ARGS_14(a, ...) BLOG_ARG(a), BLOG_ARGS_13(__VA_ARGS__)
+#define BLOG_ARGS_15(a, ...) BLOG_ARG(a), BLOG_ARGS_14(__VA_ARGS__)
+#define BLOG_ARGS_16(a, ...) BLOG_ARG(a), BLOG_ARGS_15(__VA_ARGS__)
+
+#define BLOG_NARGS_(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, \
+    _13, _14, _15, _16, n, ...) n
+#define BLOG_NARGS(...) BLOG_NARGS_(__VA_ARGS__, 16, 15, 14, 13, 12, 11, \
+    10, 9, 8, 7, 6, 5, 4, 3, 2, 1)
+#define BLOG_CAT_(a, b) a##b
+#define BLOG_CAT(a, b) BLOG_CAT_(a, b)
+#define BLOG_ARGS(...) BLOG_CAT(BLOG_ARGS_, BLOG_NARGS(__VA_ARGS__))(__VA_ARGS__)
+
+/* Emit a binary log record to binary sinks
+ *
+ * @param enum LOG_LEVEL level -- message level
+ * @param const char *fmt      -- format string in .blog_fmt section
+ * @param const blog_arg *args -- arguments
+ * @param uint8_t argc         -- amount of arguments
+ */
+void blog_bin_emit(enum LOG_LEVEL level, const char *fmt, const blog_arg *args, uint8_t argc);
+
+/* log messages of given level to text sinks only, with format string
+ * and arguments of a binary log record. Used by binary logging for 
+ * sinks that can't take binary records.
+ *
+ * @param enum LOG_LEVEL level        -- message level
+ * @param const char *restrict format
+ * @param const blog_arg *args        -- arguments
+ * @param uint8_t argc                -- amount of arguments
+ * @return int bytes written
+ */
+int blogf_text_args(enum LOG_LEVEL level, const char *restrict format, const blog_arg *args, 
+        uint8_t argc);
+
+// Never called, lets compiler check arguments against format
+static inline void __attribute__((format(printf, 1, 2))) blogf_bin_check(
+        const char *fmt __attribute__((unused)), ...) {
+}
+
+/* Log a formatted message as binary record, format must be a string 
+ * literal. Sinks that can only take text get formatted output from 
+ * the same arguments, each argument is evaluated once.
+ */
+#define blogf_bin(level, fmt, ...) do { \
+    static const char __blog_fmt[] __attribute__((section(".blog_fmt"), used)) = fmt; \
+    bool __blog_bin = console_wants(level, true); \
+    bool __blog_text = console_wants(level, false); \
+    if (0) { \
+        blogf_bin_check(fmt __VA_OPT__(,) __VA_ARGS__); \
+    } \
+    if (__blog_bin || __blog_text) { \
+        const blog_arg __blog_args[] = { __VA_OPT__(BLOG_ARGS(__VA_ARGS__)) }; \
+        uint8_t __blog_argc = (sizeof(__blog_args) / sizeof(blog_arg)); \
+        if (__blog_bin) { \
+            blog_bin_emit(level, __blog_fmt, __blog_args, __blog_argc); \
+        } \
+        if (__blog_text) { \
+            blogf_text_args(level, fmt, __blog_args, __blog_argc); \
+        } \
+    } \
+} while (0)
+
+#endif // __TINY_CONSOLE_BINLOG_H__
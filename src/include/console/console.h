@@ -35,38 +35,259 @@
 
 #include <stdarg.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <drivers/device.h>
 
-typedef size_t (*tx_func)(unsigned short addr, const char *msg, size_t len);
+// Max amount of output devices we can fan console output out to
+#define CONSOLE_MAX_SINKS       6
+// Size of per-sink line buffer
+#define CONSOLE_SINK_BUF_SIZE   128
+// How often partial lines get flushed out of sink buffers
+#define CONSOLE_FLUSH_INTERVAL_MS 100
 
+// Console sink flags
+//
+// BUFFERED -- collect output until end of line, write each line at once
+// BINARY   -- sink is a byte stream that can take binary log records, 
+//             ignored unless we're built with CONFIG_BINARY_LOG
+#define CONSOLE_SINK_BUFFERED   0x01
+#define CONSOLE_SINK_BINARY     0x02
+
+// Numeric log levels, these are for preprocessor use, everything
+// else should use enum LOG_LEVEL.
+#define LOG_LEVEL_ERROR     0
+#define LOG_LEVEL_WARNING   1
+#define LOG_LEVEL_INFO      2
+#define LOG_LEVEL_DEBUG     3
+#define LOG_LEVEL_SPEW      4
+
+// Most verbose level we build in, blog_X()/blogf_X() calls above
+// this are compiled out together with their strings. Set with
+// log_level in CMake.
+#ifndef CONFIG_LOG_LEVEL
+#define CONFIG_LOG_LEVEL LOG_LEVEL_SPEW
+#endif
+
+/* Log message levels, lower is more important. Each console sink
+ * gets messages up to and including its own level.
+ */
+enum LOG_LEVEL {
+    log_error   = LOG_LEVEL_ERROR,
+    log_warning = LOG_LEVEL_WARNING,
+    log_info    = LOG_LEVEL_INFO,
+    log_debug   = LOG_LEVEL_DEBUG,
+    log_spew    = LOG_LEVEL_SPEW
+};
+
+/* Function to write output to a console sink with
+ *
+ * @param device *dev     -- output device
+ * @param const char *msg -- data to write
+ * @param size_t len      -- amount of bytes to write
+ * @return size_t bytes written
+ */
+typedef size_t (*console_write_func)(device *dev, const char *msg, size_t len);
+
+/* Single output device console messages get sent to
+ *
+ * @member device *dev              -- output device
+ * @member console_write_func write -- function to write to it with
+ * @member char *name               -- name of this sink
+ * @member enum LOG_LEVEL level     -- most verbose level this sink gets
+ * @member bool enabled             -- is sink in use
+ * @member bool binary              -- sink gets binary log records instead of text
+ * @member char *buf                -- line buffer, NULL if unbuffered
+ * @member uint16_t buf_used        -- bytes sitting in line buffer
+ */
 typedef struct {
     device *dev;
-    size_t (*tx_func)(unsigned short port, const char *msg, size_t len);
+    console_write_func write;
+    char *name;
+    enum LOG_LEVEL level;
     bool enabled;
-} console_device;
+    bool binary;
+    char *buf;
+    uint16_t buf_used;
+} console_sink;
+
+/* Console router, every log record is passed to each sink
+ * with level high enough to want it.
+ *
+ * @member console_sink sink[CONSOLE_MAX_SINKS] -- output devices
+ * @member uint8_t count                         -- amount of sinks in use
+ * @member enum LOG_LEVEL max_level              -- most verbose level of any sink
+ */
+typedef struct {
+    console_sink sink[CONSOLE_MAX_SINKS];
+    uint8_t count;
+    enum LOG_LEVEL max_level;
+} console_router;
+
+/* Add a new output device for console messages. Buffered sinks
+ * collect output until end of line so that each line gets written 
+ * with one call, unbuffered sinks get everything as it comes.
+ *
+ * @param device *dev              -- initialised output device
+ * @param console_write_func write -- function to write to it with
+ * @param char *name               -- name of this sink
+ * @param enum LOG_LEVEL level     -- most verbose level to send to this sink
+ * @param uint8_t flags            -- CONSOLE_SINK_* flags
+ * @return pointer to console_sink or NULL if we're out of sinks
+ */
+console_sink *console_add_sink(device *dev, console_write_func write, char *name, 
+        enum LOG_LEVEL level, uint8_t flags);
+
+/* Check if any text or binary sink wants messages of given level
+ *
+ * @param enum LOG_LEVEL level -- message level
+ * @param bool binary          -- are we asking about binary sinks
+ * @return bool true if there's someone to write to
+ */
+bool console_wants(enum LOG_LEVEL level, bool binary);
+
+/* Write raw data to binary sinks that want given level
+ *
+ * @param enum LOG_LEVEL level -- record level
+ * @param const char *data     -- record to write
+ * @param size_t len           -- size of record
+ */
+void console_write_binary(enum LOG_LEVEL level, const char *data, size_t len);
 
-/* Write log message over default output device
+/* Change level of an existing console sink
+ *
+ * @param console_sink *sink   -- sink to adjust
+ * @param enum LOG_LEVEL level -- new level
+ */
+void console_set_level(console_sink *sink, enum LOG_LEVEL level);
+
+/* Stop sending console output to a device, whatever is still 
+ * buffered for it gets written out first.
+ *
+ * @param device *dev -- output device to detach
+ */
+void console_detach_device(device *dev);
+
+/* Write out everything still sitting in sink line buffers
+ */
+void console_flush(void);
+
+/* Start flushing partial lines out of sink line buffers after a 
+ * while, so that output without a newline doesn't sit in them forever.
+ * Timer is only armed while some sink holds a partial line.
+ *
+ * @return bool true if timer was armed
+ */
+bool console_start_flush_timer(void);
+
+/* Write log message of given level to all sinks that want it
+ *
+ * @param enum LOG_LEVEL level -- message level
+ * @param char *msg            -- message to print
+ */
+void blog_lvl(enum LOG_LEVEL level, char *msg);
+
+/* log messages of given level, now with format string!
+ *
+ * @param enum LOG_LEVEL level        -- message level
+ * @param const char *restrict format
+ * @param ... :3
+ * @return int bytes written
+ */
+int blogf_lvl(enum LOG_LEVEL level, const char *restrict format, ...)
+    __attribute__((format(printf, 2, 3)));
+
+/* log messages of given level with format string and va_list
+ *
+ * @param enum LOG_LEVEL level        -- message level
+ * @param const char *restrict format
+ * @param va_list ap :3
+ * @return int bytes written
+ */
+int vfblogf_lvl(enum LOG_LEVEL level, const char *restrict format, va_list ap)
+    __attribute__((format(printf, 2, 0)));
+
+/* Write log message with log_info level
  *
- * @param console_device *dev -- device to use for output
  * @param char *msg -- message to print
  *
  */
 void blog(char *msg);
 
-/* log messages, now with format string!
+/* log messages with log_info level, now with format string!
  *
  * @param const char *restrict format
  * @param ... :3
  * @return int bytes written
  */
-int blogf(const char *restrict format, ...);
+int blogf(const char *restrict format, ...) __attribute__((format(printf, 1, 2)));
 
-/* log messages, now with format string from panic() and co! 
+/* log messages with log_info level, now with format string from panic() and co! 
  *
  * @param const char *restrict format
  * @param va_list ap :3
  * @return int bytes written
  */
-int vfblogf(const char *restrict format, va_list ap);
+int vfblogf(const char *restrict format, va_list ap) __attribute__((format(printf, 1, 0)));
+
+extern console_router console;
+
+/* Check if messages of given level would end up anywhere. This is
+ * compile time constant false for levels we've built out, so code
+ * that only exists to produce log output can be wrapped in it.
+ *
+ * @param enum LOG_LEVEL level -- message level
+ * @return bool true if someone wants these messages
+ */
+static inline bool blog_enabled(enum LOG_LEVEL level) {
+    return ((level <= CONFIG_LOG_LEVEL) && (level <= console.max_level));
+}
+
+// With binary logging, level tagged formatted messages go out as
+// compact records for host side decoding, see console/binlog.h
+#ifdef CONFIG_BINARY_LOG
+#include <console/binlog.h>
+#define BLOGF(level, ...) blogf_bin(level, __VA_ARGS__)
+#else
+#define BLOGF(level, ...) blogf_lvl(level, __VA_ARGS__)
+#endif
+
+// Level tagged logging, calls above CONFIG_LOG_LEVEL don't evaluate
+// their arguments and leave nothing behind in the binary. They still
+// get type checked, so that disabled call sites don't rot.
+#define blog_error(msg)   blog_lvl(log_error, msg)
+#define blogf_error(...)  BLOGF(log_error, __VA_ARGS__)
+
+#if (CONFIG_LOG_LEVEL >= LOG_LEVEL_WARNING)
+#define blog_warning(msg)  blog_lvl(log_warning, msg)
+#define blogf_warning(...) BLOGF(log_warning, __VA_ARGS__)
+#else
+#define blog_warning(msg)  do { if (0) { blog_lvl(log_warning, msg); } } while (0)
+#define blogf_warning(...) do { if (0) { blogf_lvl(log_warning, __VA_ARGS__); } } while (0)
+#endif
+
+#if (CONFIG_LOG_LEVEL >= LOG_LEVEL_INFO)
+#define blog_info(msg)  blog_lvl(log_info, msg)
+#define blogf_info(...) BLOGF(log_info, __VA_ARGS__)
+#else
+#define blog_info(msg)  do { if (0) { blog_lvl(log_info, msg); } } while (0)
+#define blogf_info(...) do { if (0) { blogf_lvl(log_info, __VA_ARGS__); } } while (0)
+#endif
+
+#if (CONFIG_LOG_LEVEL >= LOG_LEVEL_DEBUG)
+#define blog_debug(msg)  blog_lvl(log_debug, msg)
+#define blogf_debug(...) BLOGF(log_debug, __VA_ARGS__)
+#else
+#define blog_debug(msg)  do { if (0) { blog_lvl(log_debug, msg); } } while (0)
+#define blogf_debug(...) do { if (0) { blogf_lvl(log_debug, __VA_ARGS__); } } while (0)
+#endif
+
+#if (CONFIG_LOG_LEVEL >= LOG_LEVEL_SPEW)
+#define blog_spew(msg)  blog_lvl(log_spew, msg)
+#define blogf_spew(...) BLOGF(log_spew, __VA_ARGS__)
+#else
+#define blog_spew(msg)  do { if (0) { blog_lvl(log_spew, msg); } } while (0)
+#define blogf_spew(...) do { if (0) { blogf_lvl(log_spew, __VA_ARGS__); } } while (0)
+#endif
 
 #endif // __CONSOLE_H__
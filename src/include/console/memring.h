@@ -0,0 +1,108 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2026, k4m1 <me@k4m1.net>
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+ 
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+ 
+ 3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __TINY_CONSOLE_MEMRING_H__
+#define __TINY_CONSOLE_MEMRING_H__
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <drivers/device.h>
+#include <mainboards/memory_init.h>
+
+/* Persistent in-memory console log
+ *
+ * Everything we log is also copied to a ring buffer at fixed address
+ * in low memory. The region is reported as reserved in memory map so
+ * the OS leaves it alone, and we don't clear it on boot if we find
+ * a valid header there. That way log from previous boot survives
+ * warm reset, and OS side tools can find it by scanning for the 
+ * signature.
+ *
+ * Once the ring fills up, oldest output gets overwritten and 
+ * MEMRING_FLAG_WRAPPED is set. When wrapped, oldest data starts
+ * at cursor, otherwise at 0.
+ */
+#define MEMRING_BASE            0x00090000
+#define MEMRING_SIZE            0x0000F000
+#define MEMRING_SIGNATURE       "TBIOSLOG"
+#define MEMRING_FLAG_WRAPPED    0x00000001
+
+/* Header at the start of log region
+ *
+ * @member char signature[8]    -- MEMRING_SIGNATURE
+ * @member uint32_t size        -- size of data area following header
+ * @member uint32_t cursor      -- where next byte will be written to
+ * @member uint32_t flags       -- MEMRING_FLAG_*
+ * @member uint32_t boot_count  -- boots logged since region was set up
+ * @member char data[]          -- log data
+ */
+typedef struct __attribute__((packed)) {
+    char signature[8];
+    uint32_t size;
+    uint32_t cursor;
+    uint32_t flags;
+    uint32_t boot_count;
+    char data[];
+} console_memring_header;
+
+/* Device data for in-memory console log
+ *
+ * @member console_memring_header *ring -- log region
+ */
+typedef struct {
+    console_memring_header *ring;
+} console_memring;
+
+/* Find or set up persistent console log region
+ *
+ * @param device *dev -- memring device structure
+ * @return status_initialised on success
+ */
+enum DEVICE_STATUS memring_init(device *dev);
+
+/* Mark console log region reserved in memory map
+ *
+ * @param memory_map *map -- memory map to add region to
+ */
+void memring_reserve(memory_map *map);
+
+/* Console sink write function for in-memory log
+ *
+ * @param device *dev     -- memring device structure
+ * @param const char *msg -- data to write
+ * @param size_t len      -- amount of bytes to write
+ * @return size_t bytes written
+ */
+size_t memring_console_write(device *dev, const char *msg, size_t len);
+
+#endif // __TINY_CONSOLE_MEMRING_H__
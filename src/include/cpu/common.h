@@ -32,6 +32,7 @@
 #ifndef __CPU_INST_COMMON_H__
 #define __CPU_INST_COMMON_H__
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <sys/io.h>
 
@@ -264,27 +265,92 @@ static inline void __attribute__((always_inline)) set_cr4(uint32_t v) {
     asm volatile("mov   cr4, %0"::"r"(v));
 }
 
-static inline uint32_t __attribute__((always_inline)) rdmsr(uint32_t msr) {
-    uint32_t ret;
-    asm volatile(
-            "mov   ecx, %0;"
-            "rdmsr;"
-            "mov   %1, eax;"
-            :"=r"(ret)
-            :"r"(msr)
-            :"eax","ecx"
-    );
-    return ret;
+/* Read model specific register
+ *
+ * @param uint32_t msr -- register to read
+ * @return uint64_t value, edx:eax
+ */
+static inline uint64_t __attribute__((always_inline)) rdmsr(uint32_t msr) {
+    uint32_t lo, hi;
+    asm volatile("rdmsr" : "=a"(lo), "=d"(hi) : "c"(msr));
+    return (((uint64_t)hi << 32) | lo);
+}
+
+/* Write model specific register
+ *
+ * @param uint32_t msr -- register to write
+ * @param uint64_t val -- value to write, edx:eax
+ */
+static inline void __attribute__((always_inline)) wrmsr(uint32_t msr, uint64_t val) {
+    asm volatile("wrmsr" :: "c"(msr), "a"((uint32_t)val), "d"((uint32_t)(val >> 32)));
+}
+
+/* Read time stamp counter
+ *
+ * @return uint64_t tsc value
+ */
+static inline uint64_t __attribute__((always_inline)) rdtsc(void) {
+    uint32_t lo, hi;
+    asm volatile("rdtsc" : "=a"(lo), "=d"(hi));
+    return (((uint64_t)hi << 32) | lo);
+}
+
+// cpuid leaves and feature bits we care about
+#define CPUID_FEATURES              0x00000001
+#define CPUID_FEATURES_EDX_APIC     (1U << 9)
+#define CPUID_FEATURES_ECX_HV       (1U << 31)
+#define CPUID_TSC_CRYSTAL           0x00000015
+#define CPUID_CPU_FREQUENCY         0x00000016
+#define CPUID_EXT_MAX               0x80000000
+#define CPUID_EXT_POWER             0x80000007
+#define CPUID_EXT_POWER_EDX_INVTSC  (1U << 8)
+#define CPUID_HV_BASE               0x40000000
+#define CPUID_HV_TIMING             0x40000010
+
+/* Result of cpuid instruction
+ */
+typedef struct {
+    uint32_t eax;
+    uint32_t ebx;
+    uint32_t ecx;
+    uint32_t edx;
+} cpuid_result;
+
+/* Execute cpuid for given leaf and subleaf
+ *
+ * @param uint32_t leaf    -- cpuid leaf, eax
+ * @param uint32_t subleaf -- cpuid subleaf, ecx
+ * @return cpuid_result registers we got back
+ */
+static inline cpuid_result __attribute__((always_inline)) cpuid(uint32_t leaf, uint32_t subleaf) {
+    cpuid_result r;
+    asm volatile("cpuid" 
+            : "=a"(r.eax), "=b"(r.ebx), "=c"(r.ecx), "=d"(r.edx) 
+            : "a"(leaf), "c"(subleaf));
+    return r;
 }
 
-static inline void __attribute__((always_inline)) wrmsr(uint32_t msr, uint32_t val) {
-    asm volatile(
-            "mov    ecx, %0;"
-            "mov    eax, %1;"
-            "wrmsr;"
-            ::"r"(msr),"r"(val)
-            :"eax","ecx"
-    );
+/* Read hypervisor timing leaf, eax is TSC and ebx local APIC timer 
+ * frequency in kHz. VMware came up with it, qemu/kvm provide it too 
+ * when frequencies are known and stable.
+ *
+ * @return cpuid_result of timing leaf, all zeroes if there's none
+ */
+static inline cpuid_result __attribute__((always_inline)) cpuid_hypervisor_timing(void) {
+    cpuid_result none = {0};
+    if ((cpuid(CPUID_FEATURES, 0).ecx & CPUID_FEATURES_ECX_HV) == 0) {
+        return none;
+    }
+    if (cpuid(CPUID_HV_BASE, 0).eax < CPUID_HV_TIMING) {
+        return none;
+    }
+    return cpuid(CPUID_HV_TIMING, 0);
+}
+
+/* Spin loop hint, lets the other hyperthread run while we poll
+ */
+static inline void __attribute__((always_inline)) cpu_relax(void) {
+    asm volatile("pause" ::: "memory");
 }
 
 /* Read gdtr to given 6-byte location
@@ -427,10 +493,28 @@ static inline void __attribute__((always_inline)) sti(void) {
     asm volatile("sti");
 }
 
+/* Check if maskable interrupts are currently enabled
+ *
+ * @return bool true if RFLAGS.IF is set
+ */
+static inline bool __attribute__((always_inline)) interrupts_enabled(void) {
+    uint64_t flags;
+    asm volatile("pushfq; pop %0" : "=r"(flags) :: "memory");
+    return ((flags & (1 << 9)) != 0);
+}
+
 static inline void __attribute__((always_inline)) halt(void) {
     asm volatile("hlt");
 }
 
+/* Enable interrupts and halt until one arrives. sti takes effect only
+ * after the next instruction, so nothing can sneak in between and 
+ * leave us sleeping past it.
+ */
+static inline void __attribute__((always_inline)) sti_halt(void) {
+    asm volatile("sti; hlt" ::: "memory");
+}
+
 /* Hang the cpu */
 static inline void __attribute__((always_inline, noreturn)) hang(void) {
     do {
@@ -0,0 +1,79 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2026, k4m1 <me@k4m1.net>
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+ 
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+ 
+ 3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __TINY_PERCPU_H__
+#define __TINY_PERCPU_H__
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <cpu/common.h>
+
+#define MSR_GS_BASE     0xC0000101
+
+/* Data each cpu has its own copy of, found through GS base. Reloading
+ * gs selector clears base, so whatever does that has to call 
+ * percpu_init() again after.
+ *
+ * @member percpu_data *self  -- points to itself, gs:[0]
+ * @member uint32_t index     -- cpu index, 0 for boot cpu
+ * @member uint32_t apic_id   -- local apic id
+ * @member heap_start *heap   -- heap arena tried first, NULL for main heap
+ * @member heap_cache cache[] -- free blocks of each small size class
+ */
+typedef struct percpu_data {
+    struct percpu_data *self;
+    uint32_t index;
+    uint32_t apic_id;
+    heap_start *heap;
+    heap_cache cache[HEAP_CACHE_CLASSES];
+} percpu_data;
+
+/* Point GS base of cpu we're running on to given per-cpu data
+ *
+ * @param percpu_data *data -- data for this cpu
+ */
+static inline void percpu_init(percpu_data *data) {
+    data->self = data;
+    wrmsr(MSR_GS_BASE, (uint64_t)data);
+}
+
+/* Get per-cpu data of cpu we're running on
+ *
+ * @return percpu_data *
+ */
+static inline percpu_data * __attribute__((always_inline)) this_cpu(void) {
+    percpu_data *data;
+    asm volatile("mov   %0, gs:[0]" : "=r"(data));
+    return data;
+}
+
+#endif // __TINY_PERCPU_H__
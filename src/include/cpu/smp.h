@@ -0,0 +1,187 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2026, k4m1 <me@k4m1.net>
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+ 
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+ 
+ 3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __TINY_SMP_H__
+#define __TINY_SMP_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <asm/cpu/smp.h>
+#include <cpu/percpu.h>
+#include <mainboards/memory_init.h>
+#include <sys/atomic.h>
+#include <sys/spinlock.h>
+
+// AP stacks and arenas come from heap, which is small, so don't go wild
+#define SMP_MAX_CPUS            16
+#define SMP_AP_STACK_SIZE       0x2000
+#define SMP_AP_HEAP_SIZE        0x1000
+#define SMP_QUEUE_SIZE          64
+// Idle APs halt until they get this IPI
+#define SMP_WAKE_VECTOR         0x40
+
+// Delays from the MP spec, and how long we wait for APs to check in
+#define SMP_INIT_DELAY_US       10000
+#define SMP_SIPI_DELAY_US       200
+#define SMP_AP_TIMEOUT_US       100000
+
+/* Parameters boot cpu leaves in trampoline for APs
+ *
+ * @member uint64_t cr3     -- page tables to use
+ * @member uint64_t entry   -- C function to call with cpu index
+ * @member uint64_t stacks  -- array of stack tops, by cpu index
+ * @member uint32_t next    -- next cpu index to hand out
+ * @member uint32_t max     -- cpus we have stacks for
+ */
+typedef struct __attribute__((packed)) {
+    uint64_t cr3;
+    uint64_t entry;
+    uint64_t stacks;
+    uint32_t next;
+    uint32_t max;
+} smp_trampoline_params;
+
+typedef void (*smp_work_fn)(void *arg);
+
+/* Work items queued together, to wait for all of them
+ *
+ * @member atomic_t pending -- items not yet done
+ */
+typedef struct {
+    atomic_t pending;
+} smp_work_group;
+
+typedef struct {
+    smp_work_fn fn;
+    void *arg;
+    smp_work_group *group;
+} smp_work;
+
+/* Work queue of one cpu. Owner pushes and pops at tail, others steal 
+ * oldest work from head.
+ *
+ * @member spinlock lock        -- taken by whoever touches the queue
+ * @member uint32_t head        -- next item to steal
+ * @member uint32_t tail        -- next free slot
+ * @member smp_work work[]      -- ring of work items
+ */
+typedef struct {
+    spinlock lock;
+    uint32_t head;
+    uint32_t tail;
+    smp_work work[SMP_QUEUE_SIZE];
+} smp_work_queue;
+
+/* Per cpu state
+ *
+ * @member percpu_data percpu     -- what GS base of this cpu points to
+ * @member bool online            -- running and taking work
+ * @member uint64_t done          -- work items run
+ * @member uint64_t stolen        -- of which taken from other cpus
+ * @member smp_work_queue queue   -- work queued by this cpu
+ */
+typedef struct {
+    percpu_data percpu;
+    volatile bool online;
+    uint64_t done;
+    uint64_t stolen;
+    smp_work_queue queue;
+} smp_cpu;
+
+/* SMP state
+ *
+ * @member uint32_t count     -- cpus in cpu[], boot cpu is index 0
+ * @member atomic_t online    -- cpus that have checked in
+ * @member atomic_t idle      -- APs halted or about to, waiting for work
+ * @member bool park          -- tell APs to stop taking work and halt
+ * @member smp_cpu *cpu       -- per cpu state
+ */
+typedef struct {
+    uint32_t count;
+    atomic_t online;
+    atomic_t idle;
+    volatile bool park;
+    smp_cpu *cpu;
+} smp_state;
+
+extern smp_state smp;
+
+/* Set up per-cpu data of boot cpu, before anything allocates or logs.
+ */
+void smp_boot_cpu_init(void);
+
+/* Mark trampoline page reserved in memory map
+ *
+ * @param memory_map *map -- memory map to add region to
+ */
+void smp_reserve(memory_map *map);
+
+/* Find out how many cpus we have and start application processors
+ * with INIT-SIPI-SIPI. APs take work from queues and halt while 
+ * there's none. Needs local apic.
+ *
+ * @return bool true if any AP came up
+ */
+bool smp_init(void);
+
+/* Get index of cpu we're running on in smp.cpu[]
+ *
+ * @return uint32_t cpu index, 0 for boot cpu
+ */
+static inline uint32_t smp_cpu_index(void) {
+    return this_cpu()->index;
+}
+
+/* Queue work for any cpu to run, and wake up idle APs. APs run it 
+ * with interrupts disabled, and as tasks are boot cpu only, yield()
+ * there is just a pause. Work may poll with wait_until() but must not
+ * sleep. Runs right away if queue is full.
+ *
+ * @param smp_work_group *group -- group to count work in
+ * @param smp_work_fn fn        -- function to run
+ * @param void *arg             -- argument to pass to fn
+ */
+void smp_queue_work(smp_work_group *group, smp_work_fn fn, void *arg);
+
+/* Wait until all work in group is done, helping out meanwhile. Other
+ * tasks get to run if there's nothing to do but wait.
+ *
+ * @param smp_work_group *group -- group to wait for
+ */
+void smp_work_wait(smp_work_group *group);
+
+/* Stop APs from taking work, they halt with interrupts disabled.
+ * Done before handing machine over to payload.
+ */
+void smp_park(void);
+
+#endif // __TINY_SMP_H__
@@ -51,6 +51,10 @@ enum ata_drive_id {
 
 static const uint8_t ata_cmd_identify = 0xEC;
 
+// How long we wait for status changes, drives are slow to get
+// out of busy after identify
+#define ATA_STATUS_TIMEOUT_US 100000
+
 static const uint16_t ata_ide_compability_base_addrs[] = {0x01f0, 0x0170, 0x01e8, 0x0168};
 
 static inline uint16_t ata_comp_base_to_dcr(uint16_t base) {
@@ -367,12 +371,12 @@ uint8_t init_ata_controllers(device **pci_device_array, ata_ide **ata_ide_array,
 
  /* Wait for given ata settings to change at status register
  *
- * @param ata_bus *bus -- Ata bus we're working with
- * @param uint8_t mask -- Flags to wait for
- * @param bool set     -- Are we waiting for these flags to be set or clear
- * @param uint8_t wait -- Timeout 
+ * @param ata_bus *bus          -- Ata bus we're working with
+ * @param uint8_t mask          -- Flags to wait for
+ * @param bool set              -- Are we waiting for these flags to be set or clear
+ * @param uint32_t timeout_us   -- How long to wait in microseconds
  * @return bool true if changes happen, false if timeout or error is encountered
  */
-bool ata_waitfor_status(ata_bus *bus, uint8_t mask, bool set, uint8_t wait);
+bool ata_waitfor_status(ata_bus *bus, uint8_t mask, bool set, uint32_t timeout_us);
  
 #endif // __ATA_H__
@@ -36,6 +36,9 @@
 #include <drivers/device.h>
 #include <mainboards/memory_init.h>
 
+#include <time/clock.h>
+#include <stacks/task.h>
+
 #include <stdlib.h>
 
 static const uint8_t CMOS_CLI_FLAG       = 0x80;
@@ -45,6 +48,20 @@ static const uint16_t cmos_data_addr     = 0x0071;
 static const uint16_t cmos_addr_low_mem = 0x30;
 static const uint16_t cmos_addr_high_mem = 0x31;
 
+// Non-standard NVRAM byte we keep uart baud rate selector in
+static const uint8_t cmos_addr_serial_baud = 0x48;
+
+// Longest delay we try between selecting register and reading it
+#define CMOS_MAX_IODELAY_US 20
+// RTC update in progress flag stays up for at most 2ms, per MC146818
+#define CMOS_UIP_TIMEOUT_US 2500
+
+/* CMOS device data
+ *
+ * @member uint16_t iodelay       -- microseconds to wait after selecting register
+ * @member bool rtc_bcd_enabled   -- rtc values are in bcd
+ * @member bool rtc_12hr_enabled  -- rtc hours are in 12 hour format
+ */
 typedef struct {
     uint16_t iodelay;
     bool rtc_bcd_enabled;
@@ -102,7 +119,7 @@ bool cmos_rtc_update_ongoing(device *dev);
 static inline void cmos_select_register(device *dev, uint8_t reg) {
     cmos_data *cd = dev->device_data;
     outb(reg, cmos_register_addr);
-    iodelay(cd->iodelay);
+    udelay(cd->iodelay);
 }
 
 /* Read a byte of data from CMOS register 
@@ -116,6 +133,17 @@ static inline uint8_t cmos_read(device *dev, uint8_t reg) {
     return inb(cmos_data_addr);
 }
 
+/* Read a byte of CMOS NVRAM without a device structure, for use before
+ * the CMOS driver has been initialised.
+ *
+ * @param uint8_t reg -- which cmos register are we reading
+ * @return uint8_t data
+ */
+static inline uint8_t cmos_read_raw(uint8_t reg) {
+    outb(reg, cmos_register_addr);
+    return inb(cmos_data_addr);
+}
+
 /* Write a byte of data to CMOS register
  *
  * @param device *dev -- CMOS device structure
@@ -134,9 +162,7 @@ static inline void cmos_write(device *dev, uint8_t v, uint8_t reg) {
  * @return uint8_t RTC value
  */
 static inline uint8_t rtc_read(device *dev, enum CMOS_RTC_ADDR field) {
-    // TODO: Fix -- SLOW, Get multitasking going so we aren't stuck in poll-loops
-    //
-    do {} while (cmos_rtc_update_ongoing(dev));
+    wait_until(!cmos_rtc_update_ongoing(dev), CMOS_UIP_TIMEOUT_US);
     return cmos_read(dev, field);
 }
 
@@ -0,0 +1,94 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2026, k4m1 <me@k4m1.net>
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+ 
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+ 
+ 3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __TINY_DEBUGCON_H__
+#define __TINY_DEBUGCON_H__
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <sys/io.h>
+
+#include <drivers/device.h>
+
+// Default ISA debug console port, also what qemu isa-debugcon reads
+// back when probed.
+#define DEBUGCON_DEFAULT_PORT     0x00E9
+#define DEBUGCON_DEFAULT_READBACK 0xE9
+
+/* Debug console device structure. Output is write-only, there's
+ * no status to poll and nothing to configure.
+ *
+ * @member unsigned short base_port -- port we write to
+ */
+typedef struct __attribute__((packed)) {
+    unsigned short base_port;
+} debugcon_device;
+
+/* Check if there's an ISA debug console listening on given port.
+ * Emulators return a fixed readback value, on real hardware the port
+ * is unused and floats to 0xFF.
+ *
+ * @param unsigned short port -- port to probe
+ * @return bool true if debug console is present
+ */
+static inline bool debugcon_probe(unsigned short port) {
+    return (inb(port) == DEBUGCON_DEFAULT_READBACK);
+}
+
+/* Initialise debug console. Mainboard configuration gets asked for port 
+ * first, if that doesn't say anything we probe the default port.
+ *
+ * @param device *dev -- device structure for debugcon
+ * @return status_initialised if debug console is present
+ */
+enum DEVICE_STATUS debugcon_init(device *dev);
+
+/* Write data to debug console
+ *
+ * @param unsigned short port -- debugcon port
+ * @param const char *msg     -- data to write
+ * @param size_t len          -- amount of bytes to write
+ * @return size_t bytes written
+ */
+size_t debugcon_tx(unsigned short port, const char *msg, size_t len);
+
+/* Console sink write function for debug console
+ *
+ * @param device *dev     -- debugcon device structure
+ * @param const char *msg -- data to write
+ * @param size_t len      -- amount of bytes to write
+ * @return size_t bytes written
+ */
+size_t debugcon_console_write(device *dev, const char *msg, size_t len);
+
+#endif // __TINY_DEBUGCON_H__
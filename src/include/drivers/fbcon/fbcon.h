@@ -0,0 +1,124 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2026, k4m1 <me@k4m1.net>
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+ 
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+ 
+ 3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __TINY_FBCON_H__
+#define __TINY_FBCON_H__
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <drivers/device.h>
+
+// Glyphs we have in our font, everything else is drawn as '?'
+#define FBCON_FONT_FIRST    0x20
+#define FBCON_FONT_LAST     0x7E
+#define FBCON_FONT_GLYPHS   ((FBCON_FONT_LAST - FBCON_FONT_FIRST) + 1)
+
+// Character cell size, 8x8 font is drawn with every row doubled
+#define FBCON_CELL_WIDTH    8
+#define FBCON_CELL_HEIGHT   16
+
+// Default colours, 0x00RRGGBB
+#define FBCON_FG_COLOUR     0x00AAAAAA
+#define FBCON_BG_COLOUR     0x00000000
+
+extern const uint8_t fbcon_font_8x8[FBCON_FONT_GLYPHS][8];
+
+/* Linear 32 bits per pixel framebuffer, filled in by whoever sets
+ * the display up.
+ *
+ * @member uint32_t *base       -- start of framebuffer memory
+ * @member uint32_t width       -- visible width in pixels
+ * @member uint32_t height      -- visible height in pixels
+ * @member uint32_t pitch       -- pixels per scanline in memory
+ * @member uint32_t virt_height -- scanlines we have in framebuffer memory
+ * @member device *hw           -- display device
+ * @member pan                  -- set first visible scanline, NULL if 
+ *                                 display can't pan
+ */
+typedef struct {
+    uint32_t *base;
+    uint32_t width;
+    uint32_t height;
+    uint32_t pitch;
+    uint32_t virt_height;
+    device *hw;
+    void (*pan)(device *hw, uint32_t y);
+} framebuffer;
+
+/* Framebuffer console state
+ *
+ * When display can pan and has room for two screens worth of 
+ * scanlines, every text row is drawn twice, at its ring slot and
+ * one screen below it. Scrolling then only needs to clear one row
+ * and move the visible window down by a row, once it reaches the
+ * second copy it wraps back to the first and nothing changes on
+ * screen.
+ *
+ * @member framebuffer fb           -- framebuffer we draw to
+ * @member uint32_t cols            -- text columns
+ * @member uint32_t rows            -- text rows
+ * @member uint32_t cx              -- cursor column
+ * @member uint32_t cy              -- cursor row, relative to top of screen
+ * @member uint32_t top             -- ring slot of top row on screen
+ * @member bool mirror              -- draw rows twice and scroll by panning
+ * @member uint32_t (*expand)[8]    -- font row bitmap to pixels lookup
+ */
+typedef struct {
+    framebuffer fb;
+    uint32_t cols;
+    uint32_t rows;
+    uint32_t cx;
+    uint32_t cy;
+    uint32_t top;
+    bool mirror;
+    uint32_t (*expand)[FBCON_CELL_WIDTH];
+} fbcon_console;
+
+/* Set up framebuffer console, fbcon_console.fb must be filled in
+ * before calling this.
+ *
+ * @param device *dev -- fbcon device structure
+ * @return status_initialised on success
+ */
+enum DEVICE_STATUS fbcon_init(device *dev);
+
+/* Console sink write function for framebuffer console
+ *
+ * @param device *dev     -- fbcon device structure
+ * @param const char *msg -- data to write
+ * @param size_t len      -- amount of bytes to write
+ * @return size_t bytes written
+ */
+size_t fbcon_console_write(device *dev, const char *msg, size_t len);
+
+#endif // __TINY_FBCON_H__
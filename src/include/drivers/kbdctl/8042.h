@@ -41,6 +41,9 @@
 #define KBDCTL_STAT                     0x64
 #define KBDCTL_CMD                      0x64
 
+// How long we wait for controller input/output buffer
+#define KBDCTL_TIMEOUT_US               50000
+
 /* Status byte bit definitions */
 #define KBDCTL_STAT_OUT_BUF             0x01 // Output / input status
 #define KBDCTL_STAT_IN_BUF              0x02
@@ -0,0 +1,144 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2026, k4m1 <me@k4m1.net>
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+ 
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+ 
+ 3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __TINY_LAPIC_H__
+#define __TINY_LAPIC_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <drivers/device.h>
+
+// APIC base msr, bit 11 globally enables local apic
+#define LAPIC_BASE_MSR          0x1B
+#define LAPIC_BASE_MSR_BSP      (1ULL << 8)
+#define LAPIC_BASE_MSR_ENABLE   (1ULL << 11)
+#define LAPIC_BASE_MASK         0xFFFFF000ULL
+
+// Vectors we use, spurious one needs low nibble all ones on old cpus
+#define LAPIC_TIMER_VECTOR      0x30
+#define LAPIC_SPURIOUS_VECTOR   0xFF
+
+#define LAPIC_SVR_ENABLE        0x100
+#define LAPIC_LVT_MASKED        (1 << 16)
+#define LAPIC_LVT_NMI           (4 << 8)
+#define LAPIC_LVT_EXTINT        (7 << 8)
+#define LAPIC_TIMER_ONESHOT     (0 << 17)
+// Divide configuration 0xB means divide by 1
+#define LAPIC_TIMER_DIVIDE_1    0x0B
+// How long we measure timer against TSC if nobody tells its rate
+#define LAPIC_CALIBRATE_US      10000
+
+// Interrupt command register
+#define LAPIC_ICR_INIT          (5 << 8)
+#define LAPIC_ICR_STARTUP       (6 << 8)
+#define LAPIC_ICR_PENDING       (1 << 12)
+#define LAPIC_ICR_ASSERT        (1 << 14)
+#define LAPIC_ICR_LEVEL         (1 << 15)
+#define LAPIC_ICR_ALL_BUT_SELF  (3 << 18)
+// How long we wait for IPI to be accepted
+#define LAPIC_IPI_TIMEOUT_US    1000
+
+enum LAPIC_REGISTERS {
+    lapic_reg_id            = 0x020,
+    lapic_reg_version       = 0x030,
+    lapic_reg_tpr           = 0x080,
+    lapic_reg_eoi           = 0x0B0,
+    lapic_reg_svr           = 0x0F0,
+    lapic_reg_esr           = 0x280,
+    lapic_reg_icr_lo        = 0x300,
+    lapic_reg_icr_hi        = 0x310,
+    lapic_reg_lvt_timer     = 0x320,
+    lapic_reg_lvt_lint0     = 0x350,
+    lapic_reg_lvt_lint1     = 0x360,
+    lapic_reg_lvt_error     = 0x370,
+    lapic_reg_timer_initial = 0x380,
+    lapic_reg_timer_current = 0x390,
+    lapic_reg_timer_divide  = 0x3E0
+};
+
+/* Local APIC state
+ *
+ * @member volatile uint8_t *base -- mmio base of registers
+ * @member uint32_t id            -- apic id of boot cpu
+ * @member uint64_t timer_khz     -- timer count rate, after divider
+ */
+typedef struct {
+    volatile uint8_t *base;
+    uint32_t id;
+    uint64_t timer_khz;
+} lapic_device;
+
+extern lapic_device *local_apic;
+
+static inline uint32_t lapic_read(uint32_t reg) {
+    return *(volatile uint32_t *)(local_apic->base + reg);
+}
+
+static inline void lapic_write(uint32_t reg, uint32_t value) {
+    *(volatile uint32_t *)(local_apic->base + reg) = value;
+}
+
+/* Signal end of interrupt to local apic
+ */
+static inline void __attribute__((always_inline)) lapic_eoi(void) {
+    lapic_write(lapic_reg_eoi, 0);
+}
+
+/* Initialise local apic of boot cpu in virtual wire mode, so that 
+ * 8259 interrupts keep coming in through LINT0, and find out how 
+ * fast the timer counts.
+ *
+ * @param device *dev -- device, device_data is lapic_device
+ * @return enum DEVICE_STATUS
+ */
+enum DEVICE_STATUS lapic_init(device *dev);
+
+/* Software enable local apic of an AP so that it takes fixed IPIs,
+ * LVT entries stay masked as INIT left them
+ */
+void lapic_ap_init(void);
+
+/* Fire timer interrupt once after given amount of timer counts
+ *
+ * @param uint32_t count -- counts until interrupt, 0 stops timer
+ */
+void __attribute__((no_caller_saved_registers)) lapic_timer_oneshot(uint32_t count);
+
+/* Send inter-processor interrupt and wait for it to be accepted
+ *
+ * @param uint32_t apic_id -- destination, unused with shorthands
+ * @param uint32_t icr     -- low half of interrupt command register
+ * @return bool true if IPI was sent
+ */
+bool lapic_send_ipi(uint32_t apic_id, uint32_t icr);
+
+#endif // __TINY_LAPIC_H__
@@ -91,7 +91,6 @@ uint32_t pci_read_config(pci_config_address *addr, uint8_t offset);
 void pci_write_config(pci_config_address *addr, uint8_t offset, uint32_t data);
 
 static pci_bist_register pci_read_bist(pci_device_data *dev) {
-    dev->address.offset = 0;
     pci_bist_register ret;
     ret.register_raw = (uint8_t)(pci_read_config(&dev->address, 0x0C) >> 24);
     return ret;
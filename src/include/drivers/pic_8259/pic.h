@@ -39,6 +39,8 @@
 #define PIC_EOI_MSG 0x20
 #define PIC_PRIMARY_PORT 0x20
 #define PIC_SECONDARY_PORT 0xA0
+// Settle time between initialisation words, old 8259s want ~1us
+#define PIC_IO_DELAY_US 1
 
 /* programmamble interrupt controller buffering mode
  *
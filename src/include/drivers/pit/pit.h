@@ -43,6 +43,18 @@ static const short pit_channel_1_port = 0x41;
 static const short pit_channel_2_port = 0x42;
 static const short pit_command_port   = 0x43;
 
+// Channel 2 gate and output live in system control port B
+static const short pit_ch2_control_port = 0x61;
+#define PIT_CH2_GATE        0x01
+#define PIT_CH2_SPEAKER     0x02
+#define PIT_CH2_OUT         0x20
+
+// PIT input clock
+#define PIT_FREQUENCY_HZ    1193182
+// Channel 0 interrupt rate in periodic mode, before tick device
+// switches it to one-shot
+#define PIT_TICK_HZ         1000
+
 /* Supported pit data modes:
  * 
  * @member binary -- Use traditional binary values
@@ -208,6 +220,36 @@ static inline void pit_write_readback_command(pit_readback_command *cmd) {
  */
 uint8_t pit_get_channel_mode(uint8_t channel);
 
+/* Count PIT channel 2 down from given value and measure how many
+ * TSC ticks that took. Speaker stays off.
+ *
+ * @param uint16_t count -- PIT ticks to wait for
+ * @return uint64_t tsc ticks elapsed, or 0 if channel 2 never fired
+ */
+uint64_t pit_measure_tsc(uint16_t count);
+
+/* Set PIT channel 2 counting down from 65536 over and over, so that
+ * it can be read as a free running 16-bit counter. Speaker stays off.
+ */
+void pit_ch2_free_run(void);
+
+/* Read current channel 2 count
+ *
+ * @return uint16_t count, counts down
+ */
+uint16_t pit_ch2_read(void);
+
+/* Switch channel 0 to interrupt on terminal count, it then stays 
+ * quiet until pit_oneshot() gives it something to count.
+ */
+void pit_oneshot_mode(void);
+
+/* Fire IRQ 0 once after given amount of PIT ticks
+ *
+ * @param uint16_t count -- PIT ticks until interrupt
+ */
+void __attribute__((no_caller_saved_registers)) pit_oneshot(uint16_t count);
+
 /* Setup PIT with default init.
  *
  * @param device *dev -- Device info structure
@@ -42,6 +42,8 @@
 #include <drivers/device.h>
 #include <console/console.h>
 
+#include <ringbuf.h>
+
 #define SERIAL_DATA(x)      (x)
 #define SERIAL_IE(x)        (x + 1)
 #define SERIAL_FIFO_CTRL(x) (x + 2)
@@ -53,10 +55,77 @@
 
 // Primary serial console port
 #define SERIAL_COM_PRIMARY  0x03F8
-// default baud rate divisor for 9600 brate
-#define COM_DEFAULT_BRD     0x000C
+// uart input clock divided by 16, this is the highest baud rate we
+// can program. PC uarts run off a 1.8432MHz crystal, boards with a
+// faster one can override this at build time.
+#ifndef CONFIG_SERIAL_BASE_BAUD
+#define CONFIG_SERIAL_BASE_BAUD 115200
+#endif
+// baud rate to use unless fw_cfg or CMOS say otherwise
+#ifndef CONFIG_SERIAL_BAUDRATE
+#define CONFIG_SERIAL_BAUDRATE 115200
+#endif
+// How long we poll line status before giving up, long enough for
+// a full 16 byte FIFO to drain at 9600 baud
+#define SERIAL_POLL_TIMEOUT_US  20000
+// default baud rate divisor
+#define COM_DEFAULT_BRD     (CONFIG_SERIAL_BASE_BAUD / CONFIG_SERIAL_BAUDRATE)
 // default line control value
 #define COM_DEFAULT_LINE_CTL 0x03 
+// Max amount of uarts we keep track of
+#define SERIAL_MAX_UARTS    4
+// Legacy irq line and interrupt vector of COM1/COM3
+#define SERIAL_COM_PRIMARY_IRQ    4
+#define SERIAL_COM_PRIMARY_VECTOR (0x20 + SERIAL_COM_PRIMARY_IRQ)
+// Ring buffer sizes for interrupt driven i/o, must be powers of two
+#define SERIAL_TX_RING_SIZE 4096
+#define SERIAL_RX_RING_SIZE 256
+
+// Interrupt enable register bits
+#define SERIAL_IER_RX_AVAIL     0x01
+#define SERIAL_IER_THR_EMPTY    0x02
+#define SERIAL_IER_LINE_STATUS  0x04
+#define SERIAL_IER_MODEM_STATUS 0x08
+
+// Modem control register bits, OUT2 gates the irq line on PCs
+#define SERIAL_MCR_DTR  0x01
+#define SERIAL_MCR_RTS  0x02
+#define SERIAL_MCR_OUT2 0x08
+
+// Interrupt identification values, (iir >> 1) & 7
+#define SERIAL_IIR_MODEM_STATUS 0x00
+#define SERIAL_IIR_THR_EMPTY    0x01
+#define SERIAL_IIR_RX_AVAIL     0x02
+#define SERIAL_IIR_LINE_STATUS  0x03
+#define SERIAL_IIR_RX_TIMEOUT   0x06
+
+// FIFO control register bits
+#define SERIAL_FCR_ENABLE       0x01
+#define SERIAL_FCR_CLEAR_RX     0x02
+#define SERIAL_FCR_CLEAR_TX     0x04
+#define SERIAL_FCR_64BYTE       0x20
+#define SERIAL_FCR_TRIGGER_1    0x00
+#define SERIAL_FCR_TRIGGER_4    0x40
+#define SERIAL_FCR_TRIGGER_8    0x80
+#define SERIAL_FCR_TRIGGER_14   0xC0
+
+// Default FIFO control value, enable + clear both FIFOs, 14-byte rx trigger
+#define COM_DEFAULT_FIFO_CTL (SERIAL_FCR_ENABLE | SERIAL_FCR_CLEAR_RX | \
+                              SERIAL_FCR_CLEAR_TX | SERIAL_FCR_TRIGGER_14)
+
+/* Supported uart types, told apart by what FIFO they have
+ *
+ * @member uart_8250   -- 8250/16450, no FIFO at all
+ * @member uart_16550  -- Original 16550 with a broken FIFO, treated as no FIFO
+ * @member uart_16550a -- 16550A and compatibles, 16-byte FIFO
+ * @member uart_16750  -- 16750 and compatibles, 64-byte FIFO
+ */
+enum serial_uart_type {
+    uart_8250,
+    uart_16550,
+    uart_16550a,
+    uart_16750
+};
 
 /* structure for line status register
  */
@@ -89,17 +158,39 @@ typedef struct __attribute__((packed)) {
  *
  * @member unsigned short base_port        -- which com-port is this
  * @member unsigned short baudrate_divisor -- divisor value for set baud rate
+ * @member uint32_t baudrate               -- baud rate we're running at
  * @member unsigned char line_control      -- line control settings
  * @member unsigned char fifo_control      -- fifo control settings 
+ * @member enum serial_uart_type type      -- uart type we detected
+ * @member unsigned char fifo_depth        -- bytes we can write per THR-empty wait
+ * @member bool irq_enabled                -- tx/rx go through the rings below
+ * @member ringbuf tx_ring                 -- bytes waiting to be sent by the irq handler
+ * @member ringbuf rx_ring                 -- bytes received by the irq handler
+ * @member uint32_t tx_polled              -- bytes sent by polling because tx_ring was full
+ * @member uint32_t rx_dropped             -- bytes dropped because rx_ring was full
+ * @member uint32_t rx_overruns            -- overrun errors reported by the uart
  */
 typedef struct {
     unsigned short base_port;
 
     // baud rate, LCR, and other configuration values
     unsigned short baudrate_divisor;
+    uint32_t baudrate;
     unsigned char line_control;
     unsigned char fifo_control;
 
+    // FIFO we detected
+    enum serial_uart_type type;
+    unsigned char fifo_depth;
+
+    // interrupt driven i/o
+    bool irq_enabled;
+    ringbuf tx_ring;
+    ringbuf rx_ring;
+    uint32_t tx_polled;
+    uint32_t rx_dropped;
+    uint32_t rx_overruns;
+
 } serial_uart_device;
 
 /* Helper functions for serial devices */
@@ -118,15 +209,16 @@ static inline unsigned char serial_get_line_status(unsigned short port) {
  * @param unsigned short port -- Device from which to disable interrupts from
  */
 static inline void serial_interrupts_disable(unsigned short port) {
-    outb(SERIAL_IE(port), 0);
+    outb(0, SERIAL_IE(port));
 }
 
 /* Enable interrupts for device
  *
  * @param unsigned short port -- Device from which to enable interrupts from
+ * @param unsigned char mask  -- SERIAL_IER_* bits to enable
  */
-static inline void serial_interrupts_enable(unsigned short port) {
-    outb(SERIAL_IE(port), 0);
+static inline void serial_interrupts_enable(unsigned short port, unsigned char mask) {
+    outb(mask, SERIAL_IE(port));
 }
 
 /* Get serial modem status
@@ -143,7 +235,8 @@ static inline unsigned char serial_get_modem_status(unsigned short port) {
  * @param unsigned short port -- on which device to set DLAB
  */
 static inline void serial_dlab_set(unsigned short port) {
-    outb(SERIAL_FIFO_CTRL(port), 0x80);
+    unsigned char lcr = inb(SERIAL_LCR(port));
+    outb((lcr | 0x80), SERIAL_LCR(port));
 }
 
 /* Clear Divisor Latch Access Bit
@@ -151,20 +244,19 @@ static inline void serial_dlab_set(unsigned short port) {
  * @param unsigned short port -- on which device to clear DLAB
  */
 static inline void serial_dlab_clear(unsigned short port) {
-    unsigned char stat = inb(SERIAL_FIFO_CTRL(port));
-    stat &= ~(0x80);
-    outb(SERIAL_FIFO_CTRL(port), stat);
+    unsigned char lcr = inb(SERIAL_LCR(port));
+    outb((lcr & ~(0x80)), SERIAL_LCR(port));
 }
 
-/* Set baud rate for device
+/* Set baud rate divisor for device
  *
  * @param unsigned short port -- device to set baudrate for
  * @param unsigned short brd  -- baud rate divisor
  */
 static inline void serial_set_baudrate(unsigned short port, unsigned short brd) {
     serial_dlab_set(port);
-    outb(SERIAL_DATA(port), (unsigned char)(brd & 0x00FF));
-    outb(SERIAL_IE(port), (unsigned char)((brd >> 8) & 0x00FF));
+    outb((unsigned char)(brd & 0x00FF), SERIAL_DATA(port));
+    outb((unsigned char)((brd >> 8) & 0x00FF), SERIAL_IE(port));
     serial_dlab_clear(port);
 }
 
@@ -190,6 +282,16 @@ static inline unsigned char serial_device_is_faulty(unsigned short port) {
     return (inb(SERIAL_DATA(port)) != 0xae);
 }
 
+/* Get interrupt identification register value, this shares
+ * the port with fifo control register.
+ *
+ * @param unsigned short port -- port to read iir from
+ * @return unsigned char iir
+ */
+static inline unsigned char serial_get_int_id(unsigned short port) {
+    return inb(SERIAL_FIFO_CTRL(port));
+}
+
 /* Poll for serial port until line is empty.
  *
  * @param unsigned short port -- Port to wait for
@@ -197,6 +299,23 @@ static inline unsigned char serial_device_is_faulty(unsigned short port) {
  */
 unsigned char serial_wait_for_tx_empty(unsigned short port);
 
+/* Detect what kind of FIFO the uart has, enable it, and clear it.
+ *
+ * @param serial_uart_device *sdev -- uart to probe, base_port must be set
+ * @return unsigned char amount of bytes we can push per THR-empty wait
+ */
+unsigned char serial_init_fifo(serial_uart_device *sdev);
+
+/* Change baud rate of an initialised uart. Anything still waiting to
+ * be sent goes out at the old rate first.
+ *
+ * @param device *dev   -- uart device structure
+ * @param uint32_t baud -- new baud rate, CONFIG_SERIAL_BASE_BAUD must
+ *                         be divisible by it
+ * @return bool true on success, false if baud rate can't be programmed
+ */
+bool serial_set_baud(device *dev, uint32_t baud);
+
 /* Initialise a serial port for comms
  *
  * @param device *dev     -- pointer to device structure
@@ -213,7 +332,29 @@ enum DEVICE_STATUS serial_init_device(device *dev);
  */
 size_t serial_tx(unsigned short port, const char *msg, size_t len);
 
+/* Console sink write function for uarts
+ *
+ * @param device *dev     -- uart device structure
+ * @param const char *msg -- data to write
+ * @param size_t len      -- amount of bytes to write
+ * @return size_t bytes written
+ */
+size_t serial_console_write(device *dev, const char *msg, size_t len);
+
+/* Console sink write function for uarts carrying binary log records,
+ * no LF to CRLF translation.
+ *
+ * @param device *dev     -- uart device structure
+ * @param const char *msg -- data to write
+ * @param size_t len      -- amount of bytes to write
+ * @return size_t bytes written
+ */
+size_t serial_console_write_raw(device *dev, const char *msg, size_t len);
+
 /* Receive a string over serial line
+ *
+ * With interrupts enabled this only returns what the irq handler has
+ * already received and never waits.
  *
  * @param unsigned short port -- Device to read from
  * @param unsigned char *dst -- Buffer to read to
@@ -222,6 +363,27 @@ size_t serial_tx(unsigned short port, const char *msg, size_t len);
  */
 size_t serial_rx(unsigned short port, char *dst, const size_t size);
 
+/* Get amount of received bytes waiting to be read
+ *
+ * @param unsigned short port -- Device to check
+ * @return size_t bytes available without waiting
+ */
+size_t serial_rx_available(unsigned short port);
+
+/* Switch uart over to interrupt driven tx/rx. Interrupt controller
+ * must be initialised before calling this.
+ *
+ * @param device *dev -- uart device structure
+ * @return bool true on success
+ */
+bool serial_enable_irq(device *dev);
+
+/* Print dropped byte and overrun counters of a uart
+ *
+ * @param device *dev -- uart device structure
+ */
+void serial_print_stats(device *dev);
+
 /* printf() over serial line 
  *
  * @param unsigned short port -- Device to write to
@@ -231,9 +393,24 @@ size_t serial_rx(unsigned short port, char *dst, const size_t size);
  */
 int serprintf(const char *restrict format, ...);
 
+/* Get amount of bits on the line per byte sent with given line control,
+ * start bit included.
+ *
+ * @param unsigned char lcr -- line control value
+ * @return unsigned int bits per byte
+ */
+static inline unsigned int serial_bits_per_byte(unsigned char lcr) {
+    unsigned int bits = 1 + 5 + (lcr & 0x03);
+    bits += (lcr & 0x04) ? 2 : 1;
+    bits += (lcr & 0x08) ? 1 : 0;
+    return bits;
+}
+
 static inline void uart_print_info(device *dev) {
     serial_uart_device *sdev = dev->device_data;
-    blogf("%s: %04x / %04x baud\n", dev->device_name, sdev->base_port, (115200 / sdev->baudrate_divisor));
+    blogf("%s: %04x / %d baud, %d bytes/s, %d byte fifo\n", dev->device_name, sdev->base_port,
+        sdev->baudrate, (sdev->baudrate / serial_bits_per_byte(sdev->line_control)), 
+        sdev->fifo_depth);
 }
 
 #endif // __SERIAL_H__
@@ -0,0 +1,97 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2026, k4m1 <me@k4m1.net>
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+ 
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+ 
+ 3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __TINY_VGATEXT_H__
+#define __TINY_VGATEXT_H__
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <drivers/device.h>
+
+// Legacy colour text mode buffer, 80x25 cells of char + attribute
+#define VGATEXT_BUFFER      0xB8000
+#define VGATEXT_COLS        80
+#define VGATEXT_ROWS        25
+
+// Light grey on black
+#define VGATEXT_ATTR        0x07
+#define VGATEXT_BLANK       ((VGATEXT_ATTR << 8) | ' ')
+
+// Misc output register, bit 0 selects colour (0x3D4) or 
+// mono (0x3B4) CRTC i/o address.
+#define VGA_MISC_OUT_RD     0x03CC
+#define VGA_MISC_IO_COLOUR  0x01
+#define VGA_CRTC_COLOUR     0x03D4
+#define VGA_CRTC_MONO       0x03B4
+
+enum VGA_CRTC_REGISTERS {
+    vga_crtc_cursor_start   = 0x0A,
+    vga_crtc_cursor_end     = 0x0B,
+    vga_crtc_cursor_hi      = 0x0E,
+    vga_crtc_cursor_lo      = 0x0F
+};
+
+/* VGA text mode console state. Text mode itself has to be set up 
+ * already, by hardware defaults or video option rom, we only draw.
+ *
+ * @member volatile uint16_t *buf   -- text buffer
+ * @member unsigned short crtc      -- crtc index port, data is one above
+ * @member uint16_t cx              -- cursor column
+ * @member uint16_t cy              -- cursor row
+ */
+typedef struct {
+    volatile uint16_t *buf;
+    unsigned short crtc;
+    uint16_t cx;
+    uint16_t cy;
+} vgatext_console;
+
+/* Initialise VGA text console, checks that there's memory behind
+ * the text buffer and clears the screen.
+ *
+ * @param device *dev -- vgatext device structure
+ * @return status_initialised if text buffer is present
+ */
+enum DEVICE_STATUS vgatext_init(device *dev);
+
+/* Console sink write function for VGA text console. Hardware
+ * cursor is moved once per call, not per character.
+ *
+ * @param device *dev     -- vgatext device structure
+ * @param const char *msg -- data to write
+ * @param size_t len      -- amount of bytes to write
+ * @return size_t bytes written
+ */
+size_t vgatext_console_write(device *dev, const char *msg, size_t len);
+
+#endif // __TINY_VGATEXT_H__
@@ -0,0 +1,82 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2026, k4m1 <me@k4m1.net>
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+ 
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+ 
+ 3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __TINY_INIT_GRAPH_H__
+#define __TINY_INIT_GRAPH_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Steps are referred to by index in dependency masks
+#define INIT_MAX_STEPS      32
+#define INIT_DEP(step)      (1U << (step))
+// Steps running at once, each task takes TASK_STACK_SIZE of heap
+#define INIT_MAX_TASKS      4
+
+enum INIT_STEP_STATE {
+    init_step_waiting,
+    init_step_running,
+    init_step_done
+};
+
+/* One step of bring-up, runs once everything in deps is done. Steps
+ * with no dependencies between them run concurrently as tasks.
+ *
+ * @member char *name                -- name for logging
+ * @member void (*run)(void)         -- do the thing
+ * @member uint32_t deps             -- INIT_DEP() mask of steps needed first
+ * @member enum INIT_STEP_STATE state
+ * @member uint64_t ready_ns         -- now_ns() when last dependency finished
+ * @member uint64_t start_ns         -- now_ns() when step started
+ * @member uint64_t end_ns           -- now_ns() when step finished
+ * @member int8_t critical_dep       -- dependency that finished last, -1 if none
+ */
+typedef struct {
+    char *name;
+    void (*run)(void);
+    uint32_t deps;
+    enum INIT_STEP_STATE state;
+    uint64_t ready_ns;
+    uint64_t start_ns;
+    uint64_t end_ns;
+    int8_t critical_dep;
+} init_step;
+
+/* Run steps in dependency order, independent ones concurrently, and
+ * report the chain of steps that bounded total time. Returns once all
+ * steps are done. Panics on dependency cycles.
+ *
+ * @param init_step *steps -- steps to run
+ * @param uint8_t count    -- amount of steps, at most INIT_MAX_STEPS
+ */
+void init_graph_run(init_step *steps, uint8_t count);
+
+#endif // __TINY_INIT_GRAPH_H__
@@ -74,6 +74,8 @@ typedef struct __attribute__((packed)) {
     idt_entry entry[256];
 } int_desc_table;
 
+extern int_desc_table *idt;
+
 /* Allocate memory for interrupt descriptor table
  *
  * @return pointer to allocated interrupt descriptor table
@@ -0,0 +1,95 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2026, k4m1 <me@k4m1.net>
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+ 
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+ 
+ 3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __TINY_MAINBOARD_CONFIG_H__
+#define __TINY_MAINBOARD_CONFIG_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <drivers/device.h>
+#include <drivers/fbcon/fbcon.h>
+
+/* Mainboard-specific runtime configuration knobs. Each of these return 0
+ * when mainboard has nothing to say, and the caller falls back to CMOS
+ * and/or build time defaults.
+ */
+
+/* Get baud rate to use for the primary uart
+ *
+ * @return uint32_t baud rate, or 0 if not configured
+ */
+uint32_t mainboard_uart_baudrate(void);
+
+/* Get port of ISA debug console, if mainboard knows we have one
+ *
+ * @return uint16_t port, or 0 if not configured
+ */
+uint16_t mainboard_debugcon_port(void);
+
+/* Get TSC frequency if mainboard knows it, so that we don't need to
+ * calibrate it.
+ *
+ * @return uint32_t TSC frequency in kHz, or 0 if not configured
+ */
+uint32_t mainboard_tsc_khz(void);
+
+/* Find and set up a display we can draw a console on
+ *
+ * @param device **pci_devs -- pci devices we've found
+ * @param uint8_t count     -- amount of pci devices
+ * @param framebuffer *fb   -- framebuffer description to fill in
+ * @return bool true if there's a framebuffer to use
+ */
+bool mainboard_framebuffer(device **pci_devs, uint8_t count, framebuffer *fb);
+
+/* Enable ACPI power management registers and tell where they are,
+ * PM timer is at offset 8.
+ *
+ * @param device **pci_devs -- pci devices we've found
+ * @param uint8_t count     -- amount of pci devices
+ * @return uint16_t pm i/o base, or 0 if there's none
+ */
+uint16_t mainboard_acpi_pm_base(device **pci_devs, uint8_t count);
+
+/* Get address of HPET registers
+ *
+ * @return uint64_t HPET base address, or 0 if there's none
+ */
+uint64_t mainboard_hpet_base(void);
+
+/* Get amount of cpus, boot cpu included
+ *
+ * @return uint32_t cpu count, or 0 if mainboard doesn't know
+ */
+uint32_t mainboard_cpu_count(void);
+
+#endif // __TINY_MAINBOARD_CONFIG_H__
@@ -34,6 +34,7 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <drivers/device.h>
 
 // First address after the 15 megabyte area
@@ -50,11 +51,74 @@ typedef struct {
     uint8_t count;
 } memory_map;
 
-static inline void mmap_add_entry(memory_map *map, uint64_t addr, uint64_t size, uint32_t type) {
+/* Add a new entry to memory map
+ *
+ * @param memory_map *map -- memory map to add entry to
+ * @param uint64_t addr   -- start of region
+ * @param uint64_t size   -- size of region
+ * @param uint32_t type   -- e820 type of region
+ * @return bool true on success
+ */
+static inline bool mmap_add_entry(memory_map *map, uint64_t addr, uint64_t size, uint32_t type) {
+    if (map->count == (sizeof(map->entry) / sizeof(e820_e *))) {
+        return false;
+    }
+    map->entry[map->count] = calloc(1, sizeof(e820_e));
+    if (!map->entry[map->count]) {
+        return false;
+    }
     map->entry[map->count]->addr = addr;
     map->entry[map->count]->size = size;
     map->entry[map->count]->type = type;
     map->count++;
+    return true;
+}
+
+/* Mark a region reserved in memory map. Usable RAM entries it 
+ * overlaps are trimmed or split around it, so that no range shows up
+ * as both usable and reserved.
+ *
+ * @param memory_map *map -- memory map to add entry to
+ * @param uint64_t addr   -- start of region
+ * @param uint64_t size   -- size of region
+ * @return bool true on success
+ */
+static inline bool mmap_reserve(memory_map *map, uint64_t addr, uint64_t size) {
+    uint64_t end = addr + size;
+    uint8_t i = 0;
+
+    while (i < map->count) {
+        e820_e *e = map->entry[i];
+        uint64_t e_end = e->addr + e->size;
+        if ((e->type != 1) || (e_end <= addr) || (e->addr >= end)) {
+            i++;
+            continue;
+        }
+        if ((e->addr >= addr) && (e_end <= end)) {
+            // All of it is reserved now, drop it
+            free(e);
+            map->count--;
+            for (uint8_t j = i; j < map->count; j++) {
+                map->entry[j] = map->entry[j + 1];
+            }
+            continue;
+        }
+        if ((e->addr < addr) && (e_end > end)) {
+            // Reserved region in the middle, RAM after it gets an entry
+            // of its own
+            if (!mmap_add_entry(map, end, (e_end - end), 1)) {
+                return false;
+            }
+            e->size = (addr - e->addr);
+        } else if (e->addr < addr) {
+            e->size = (addr - e->addr);
+        } else {
+            e->addr = end;
+            e->size = (e_end - end);
+        }
+        i++;
+    }
+    return mmap_add_entry(map, addr, size, 2);
 }
 
 /* Mainboard-specific helper to resolve memory map for us.
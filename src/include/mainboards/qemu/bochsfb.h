@@ -36,6 +36,7 @@
 #include <sys/io.h>
 
 #include <drivers/device.h>
+#include <drivers/fbcon/fbcon.h>
 
 #include <stdbool.h>
 #include <stdint.h>
@@ -43,6 +44,15 @@
 static const uint16_t bochs_vbe_ioidx = 0x01CE;
 static const uint16_t bochs_vbe_ioval = 0x01CF;
 
+// PCI ids of qemu/bochs std vga
+static const uint16_t bochs_vga_vendor_id = 0x1234;
+static const uint16_t bochs_vga_device_id = 0x1111;
+
+// Where we place linear framebuffer, and mode we set up
+static const uint32_t bochs_fb_addr   = 0xFD000000;
+static const uint16_t bochs_fb_xres   = 640;
+static const uint16_t bochs_fb_yres   = 480;
+
 enum BOCHS_VBE_IDX {
     bochs_vbe_idx_id = 0,
     bochs_vbe_idx_xres,
@@ -122,4 +132,29 @@ static inline uint16_t __attribute__((always_inline)) bochs_vbe_version(uint16_t
     return bochs_vbe_in(addr, bochs_vbe_idx_id);
 }
 
+/**
+ * Enable and initialise bochs framebuffer.
+ *
+ * @param dev Is a pointer to preallocated device structure.
+ * @return status of vga device
+ */
+enum DEVICE_STATUS init_vga_controller(device *vgadev);
+
+/**
+ * Set first visible scanline of bochs framebuffer.
+ *
+ * @param vgadev Is the vga device.
+ * @param y Is the scanline to show on top of screen.
+ */
+void bochs_fb_pan(device *vgadev, uint32_t y);
+
+/**
+ * Describe initialised bochs framebuffer for fbcon.
+ *
+ * @param vgadev Is the vga device.
+ * @param fb Is the framebuffer structure to fill in.
+ * @return true if framebuffer is usable.
+ */
+bool bochs_fb_describe(device *vgadev, framebuffer *fb);
+
 #endif // __TINY_BOCHS_FB_H__
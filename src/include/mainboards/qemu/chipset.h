@@ -0,0 +1,68 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2026, k4m1 <me@k4m1.net>
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+ 
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+ 
+ 3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __TINY_QEMU_CHIPSET_H__
+#define __TINY_QEMU_CHIPSET_H__
+
+#include <drivers/device.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// i440fx machine, PIIX4 power management function
+static const uint16_t piix4_pm_vendor_id  = 0x8086;
+static const uint16_t piix4_pm_device_id  = 0x7113;
+static const uint8_t  piix4_pm_reg_pmba   = 0x40;
+static const uint8_t  piix4_pm_reg_pmregmisc = 0x80;
+#define PIIX4_PMREGMISC_PMIOSE 0x01
+
+// q35 machine, ICH9 LPC bridge
+static const uint16_t ich9_lpc_vendor_id  = 0x8086;
+static const uint16_t ich9_lpc_device_id  = 0x2918;
+static const uint8_t  ich9_lpc_reg_pmbase = 0x40;
+static const uint8_t  ich9_lpc_reg_acpi_cntl = 0x44;
+#define ICH9_ACPI_CNTL_ACPI_EN 0x80
+
+// Where we place ACPI power management registers, same as seabios
+static const uint16_t qemu_acpi_pm_base   = 0xB000;
+
+// qemu has HPET at the architectural default address on both machines
+static const uint64_t qemu_hpet_base      = 0xFED00000;
+
+/* Enable ACPI power management i/o block of whichever chipset we're on
+ *
+ * @param device **pci_devs -- pci devices we've found
+ * @param uint8_t count     -- amount of pci devices
+ * @return uint16_t base of pm i/o block, or 0 if chipset is unknown
+ */
+uint16_t qemu_acpi_pm_enable(device **pci_devs, uint8_t count);
+
+#endif // __TINY_QEMU_CHIPSET_H__
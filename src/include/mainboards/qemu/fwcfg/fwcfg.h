@@ -111,6 +111,17 @@ bool qemu_fwcfg_present(void);
  */
 fwcfg_file *fwcfg_find_file_entry(char *name);
 
+/* Read up to size bytes of a fw-cfg file into a caller provided
+ * buffer. Missing files are not an error here, this is meant for
+ * optional configuration knobs.
+ *
+ * @param char *name    -- Name of file to read
+ * @param void *dst     -- Where to read the file to
+ * @param uint32_t size -- Size of dst
+ * @return uint32_t amount of bytes read, 0 if file is not there
+ */
+uint32_t fwcfg_read_file_into(char *name, void *dst, uint32_t size);
+
  /* Read a file from qemu fw-cfg files
  *
  * @param fwcfg_file *file -- Pointer to populated fwcfg structure
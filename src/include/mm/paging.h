@@ -73,4 +73,10 @@ static inline page_table_entry *alloc_map(uint64_t entry_count) {
 
 void init_paging(memory_map *mem_map);
 
+/**
+ * Make sure given region is mapped, such as mmio past end of ram.
+ * Size must be page aligned.
+ */
+bool map_address(void *addr, uint64_t size);
+
 #endif
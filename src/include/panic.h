@@ -37,7 +37,7 @@
 
 #include <stdarg.h>
 
-void __attribute__((noreturn)) panic(const char *restrict msg, ...);
+void __attribute__((noreturn, format(printf, 1, 2))) panic(const char *restrict msg, ...);
 #define panic_oom(...) panic("Out of memory while %s\n", __VA_ARGS__);
 
 #endif // __PANIC_H__
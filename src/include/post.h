@@ -37,16 +37,19 @@
 #include <drivers/device.h>
 #include <console/console.h>
 
-/* Initialize a output device, and make it our default
- * output device for blogf, panic, etc.
+/* Initialize a output device, and add it to console sinks
+ * for blogf, panic, etc.
  *
- * @param device *dev                    -- Target device structure
- * @param device_init_function init_func -- Init function to use for the device
- * @param tx_func write_func             -- Function to use for writing output to this device
- * @param char *name                     -- Name of our output device
- * @return bool true if switch succeeded
+ * @param device *dev                        -- Target device structure
+ * @param device_init_function init_func     -- Init function to use for the device
+ * @param console_write_func write_func      -- Function to use for writing output to this device
+ * @param char *name                         -- Name of our output device
+ * @param enum LOG_LEVEL level               -- Most verbose messages to send to this device
+ * @param uint8_t flags                      -- CONSOLE_SINK_* flags
+ * @return bool true if device was added
  */
-bool switch_output_device(device *dev, device_init_function init_func, char *name);
+bool attach_output_device(device *dev, device_init_function init_func, 
+        console_write_func write_func, char *name, enum LOG_LEVEL level, uint8_t flags);
 
 /* Perform power-on-self-test and bring up
  * systems we need early on, such as disk controllers etc.
@@ -0,0 +1,174 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2026, k4m1 <me@k4m1.net>
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+ 
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+ 
+ 3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __TINY_RINGBUF_H__
+#define __TINY_RINGBUF_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Lock-free single-producer/single-consumer byte ring.
+ *
+ * Producer only ever writes head, consumer only ever writes tail, so one
+ * side may live in an interrupt handler while the other runs in normal
+ * context without any locking. Both indices run freely and are masked on
+ * access, size must be a power of two.
+ *
+ * @member uint8_t *data  -- Backing storage
+ * @member uint32_t size  -- Size of backing storage, power of two
+ * @member uint32_t head  -- Next slot to write, owned by producer
+ * @member uint32_t tail  -- Next slot to read, owned by consumer
+ */
+typedef struct {
+    uint8_t *data;
+    uint32_t size;
+    uint32_t head;
+    uint32_t tail;
+} ringbuf;
+
+/* Setup ring to use given backing storage
+ *
+ * @param ringbuf *rb   -- Ring to initialise
+ * @param uint8_t *data -- Backing storage
+ * @param uint32_t size -- Size of backing storage, must be a power of two
+ */
+static inline void ringbuf_init(ringbuf *rb, uint8_t *data, uint32_t size) {
+    rb->data = data;
+    rb->size = size;
+    rb->head = 0;
+    rb->tail = 0;
+}
+
+/* Get amount of bytes waiting in the ring
+ *
+ * @param ringbuf *rb -- Ring to check
+ * @return uint32_t bytes used
+ */
+static inline uint32_t ringbuf_used(ringbuf *rb) {
+    uint32_t head = __atomic_load_n(&rb->head, __ATOMIC_ACQUIRE);
+    uint32_t tail = __atomic_load_n(&rb->tail, __ATOMIC_ACQUIRE);
+    return (head - tail);
+}
+
+/* Get amount of bytes we can still write to the ring
+ *
+ * @param ringbuf *rb -- Ring to check
+ * @return uint32_t bytes free
+ */
+static inline uint32_t ringbuf_free(ringbuf *rb) {
+    return (rb->size - ringbuf_used(rb));
+}
+
+/* Check if there's nothing to read
+ *
+ * @param ringbuf *rb -- Ring to check
+ * @return bool true if ring is empty
+ */
+static inline bool ringbuf_empty(ringbuf *rb) {
+    return (ringbuf_used(rb) == 0);
+}
+
+/* Producer: add a single byte to the ring
+ *
+ * @param ringbuf *rb -- Ring to write to
+ * @param uint8_t c   -- Byte to add
+ * @return bool false if ring is full
+ */
+static inline bool ringbuf_put(ringbuf *rb, uint8_t c) {
+    uint32_t head = rb->head;
+    if ((head - __atomic_load_n(&rb->tail, __ATOMIC_ACQUIRE)) >= rb->size) {
+        return false;
+    }
+    rb->data[head & (rb->size - 1)] = c;
+    __atomic_store_n(&rb->head, (head + 1), __ATOMIC_RELEASE);
+    return true;
+}
+
+/* Consumer: take a single byte out of the ring
+ *
+ * @param ringbuf *rb -- Ring to read from
+ * @param uint8_t *c  -- Where to store the byte
+ * @return bool false if ring is empty
+ */
+static inline bool ringbuf_get(ringbuf *rb, uint8_t *c) {
+    uint32_t tail = rb->tail;
+    if (__atomic_load_n(&rb->head, __ATOMIC_ACQUIRE) == tail) {
+        return false;
+    }
+    *c = rb->data[tail & (rb->size - 1)];
+    __atomic_store_n(&rb->tail, (tail + 1), __ATOMIC_RELEASE);
+    return true;
+}
+
+/* Producer: add as many bytes as fit to the ring
+ *
+ * @param ringbuf *rb    -- Ring to write to
+ * @param const void *src -- Bytes to add
+ * @param size_t len     -- Amount of bytes to add
+ * @return size_t amount of bytes added
+ */
+static inline size_t ringbuf_write(ringbuf *rb, const void *src, size_t len) {
+    const uint8_t *s = src;
+    uint32_t head = rb->head;
+    uint32_t room = rb->size - (head - __atomic_load_n(&rb->tail, __ATOMIC_ACQUIRE));
+    if (len > room) {
+        len = room;
+    }
+    for (size_t i = 0; i < len; i++) {
+        rb->data[(head + i) & (rb->size - 1)] = s[i];
+    }
+    __atomic_store_n(&rb->head, (uint32_t)(head + len), __ATOMIC_RELEASE);
+    return len;
+}
+
+/* Consumer: take up to len bytes out of the ring
+ *
+ * @param ringbuf *rb -- Ring to read from
+ * @param void *dst   -- Where to copy the bytes
+ * @param size_t len  -- Max amount of bytes to take
+ * @return size_t amount of bytes taken
+ */
+static inline size_t ringbuf_read(ringbuf *rb, void *dst, size_t len) {
+    uint8_t *d = dst;
+    uint32_t tail = rb->tail;
+    uint32_t avail = __atomic_load_n(&rb->head, __ATOMIC_ACQUIRE) - tail;
+    if (len > avail) {
+        len = avail;
+    }
+    for (size_t i = 0; i < len; i++) {
+        d[i] = rb->data[(tail + i) & (rb->size - 1)];
+    }
+    __atomic_store_n(&rb->tail, (uint32_t)(tail + len), __ATOMIC_RELEASE);
+    return len;
+}
+
+#endif // __TINY_RINGBUF_H__
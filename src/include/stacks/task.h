@@ -0,0 +1,111 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2026, k4m1 <me@k4m1.net>
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+ 
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+ 
+ 3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __TINY_TASK_H__
+#define __TINY_TASK_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <time/clock.h>
+
+// Stack given to each task, interrupt handlers and blogf() run on it
+// too so don't go too low
+#define TASK_STACK_SIZE     0x4000
+
+typedef void (*task_entry)(void *arg);
+
+/* Cooperatively scheduled task, has its own stack and runs until it
+ * yields. Boot flow itself is the main task, running on boot stack.
+ *
+ * @member uint64_t rsp          -- saved stack pointer while switched out
+ * @member struct task *next     -- next task on run ring
+ * @member task_entry entry      -- function task runs
+ * @member void *arg             -- argument for entry
+ * @member void *stack           -- bottom of allocated stack
+ * @member char *name            -- name for logging
+ * @member uint64_t started_ns   -- now_ns() when task was spawned
+ */
+typedef struct task {
+    uint64_t rsp;
+    struct task *next;
+    task_entry entry;
+    void *arg;
+    void *stack;
+    char *name;
+    uint64_t started_ns;
+} task;
+
+/* Start a new task, it gets to run on next yield(). Task is freed 
+ * once entry returns.
+ *
+ * @param char *name        -- name for logging
+ * @param task_entry entry  -- function to run
+ * @param void *arg         -- argument for entry
+ * @return bool true if task was created, false if we're out of memory
+ */
+bool task_spawn(char *name, task_entry entry, void *arg);
+
+/* Let other tasks run, returns once everyone else has had their turn.
+ * Only to be called from task context, not from interrupt handlers.
+ * Tasks are boot cpu only, work running on APs just gets a pause.
+ */
+void yield(void);
+
+/* Yield until all spawned tasks are done. Only main task may join.
+ */
+void task_join_all(void);
+
+/* Get amount of tasks running besides main task
+ *
+ * @return uint32_t tasks
+ */
+uint32_t task_count(void);
+
+/* Poll condition until it holds or timeout expires, letting other 
+ * tasks run in between polls. Condition is an expression, evaluated
+ * again on every round.
+ *
+ * @param cond                  -- expression to wait for
+ * @param uint64_t timeout_us   -- how long to wait in microseconds
+ * @return bool true if condition holds, false on timeout
+ */
+#define wait_until(cond, timeout_us) ({                             \
+    uint64_t __wait_deadline = deadline_us(timeout_us);             \
+    bool __wait_met;                                                \
+    while (!(__wait_met = (cond)) &&                                \
+            !deadline_passed(__wait_deadline)) {                    \
+        yield();                                                    \
+    }                                                               \
+    __wait_met;                                                     \
+})
+
+#endif // __TINY_TASK_H__
@@ -36,20 +36,45 @@
 #include <stdint.h>
 
 #include <panic.h>
+#include <sys/spinlock.h>
+
+// Arenas besides main heap, free() looks up owner of a pointer 
+// among these
+#define HEAP_MAX_ARENAS 16
+
+// Per-cpu caches of free blocks for small allocations, size classes
+// are HEAP_CACHE_MIN << class. Caches refill from and drain to heap
+// HEAP_CACHE_BATCH blocks at a time, under one lock.
+#define HEAP_CACHE_CLASSES  4
+#define HEAP_CACHE_MIN      32
+#define HEAP_CACHE_SLOTS    8
+#define HEAP_CACHE_BATCH    4
 
 typedef struct memory_header { 
     struct memory_header *previous;
     struct memory_header *next;
     uint64_t size;
     bool free;
+    bool cached;    // sitting in a per-cpu cache, free as far as caller knows
 } memory_header;
 
 typedef struct {
     uint64_t size;
     struct memory_header *start;
+    spinlock lock;
 } heap_start;
 
+typedef struct {
+    uint32_t count;
+    void *slot[HEAP_CACHE_SLOTS];
+} heap_cache;
+
+// Cleared to send everything straight to heap, for benchmarking
+extern bool heap_cache_enabled;
+
 void heap_init(uint64_t start, uint64_t size);
+heap_start *heap_arena_create(uint64_t size);
+void heap_cache_drain(void);
 void *malloc(uint64_t size);
 void *calloc(uint64_t nmemb, uint64_t size);
 void *realloc(void *ptr, uint64_t size);
@@ -0,0 +1,98 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2026, k4m1 <me@k4m1.net>
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+ 
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+ 
+ 3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __TINY_ATOMIC_H__
+#define __TINY_ATOMIC_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Counter that's safe to update from several cpus at once. Plain 
+ * loads and stores of it are fine, read-modify-write goes through
+ * these helpers.
+ *
+ * @member uint64_t value -- current value
+ */
+typedef struct {
+    volatile uint64_t value;
+} atomic_t;
+
+#define ATOMIC_INIT(v) { .value = (v) }
+
+static inline uint64_t atomic_read(atomic_t *a) {
+    return __atomic_load_n(&a->value, __ATOMIC_ACQUIRE);
+}
+
+static inline void atomic_set(atomic_t *a, uint64_t v) {
+    __atomic_store_n(&a->value, v, __ATOMIC_RELEASE);
+}
+
+/* Add to counter
+ *
+ * @param atomic_t *a -- counter
+ * @param uint64_t v  -- amount to add
+ * @return uint64_t value after adding
+ */
+static inline uint64_t atomic_add(atomic_t *a, uint64_t v) {
+    return __atomic_add_fetch(&a->value, v, __ATOMIC_ACQ_REL);
+}
+
+/* Subtract from counter
+ *
+ * @param atomic_t *a -- counter
+ * @param uint64_t v  -- amount to subtract
+ * @return uint64_t value after subtracting
+ */
+static inline uint64_t atomic_sub(atomic_t *a, uint64_t v) {
+    return __atomic_sub_fetch(&a->value, v, __ATOMIC_ACQ_REL);
+}
+
+static inline uint64_t atomic_inc(atomic_t *a) {
+    return atomic_add(a, 1);
+}
+
+static inline uint64_t atomic_dec(atomic_t *a) {
+    return atomic_sub(a, 1);
+}
+
+/* Replace counter value if it's still what we expect
+ *
+ * @param atomic_t *a    -- counter
+ * @param uint64_t old   -- value we expect it to have
+ * @param uint64_t new   -- value to store
+ * @return bool true if value was replaced
+ */
+static inline bool atomic_cmpxchg(atomic_t *a, uint64_t old, uint64_t new) {
+    return __atomic_compare_exchange_n(&a->value, &old, new, false, 
+            __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+#endif // __TINY_ATOMIC_H__
@@ -34,6 +34,47 @@
 
 #include <stdint.h>
 
+// Port i/o accounting, build with -Dio_accounting=ON. Under emulators
+// and hypervisors every port access is a trip out of the guest, so 
+// knowing who does how many is what tells where boot time goes.
+// 
+#ifdef CONFIG_IO_ACCOUNTING
+
+// Amount of subsystems io_account_report() lists
+#define IO_ACCOUNT_TOP_N    10
+
+enum IO_ACCOUNT_DIR {
+    io_account_read,
+    io_account_write
+};
+
+// Record port access that started at given TSC value, see io_account.c
+void __attribute__((no_caller_saved_registers)) io_account(unsigned short port, 
+        enum IO_ACCOUNT_DIR dir, uint64_t count, uint64_t start);
+
+// Print subsystems that did most port i/o, by cycles spent
+void io_account_report(unsigned int top_n);
+
+static inline uint64_t __attribute__((always_inline)) io_account_tsc(void) {
+    uint32_t lo, hi;
+    asm volatile("rdtsc" : "=a"(lo), "=d"(hi));
+    return (((uint64_t)hi << 32) | lo);
+}
+
+#define IO_ACCOUNT_BEGIN()                  uint64_t __io_start = io_account_tsc()
+#define IO_ACCOUNT_END(port, dir, count)    io_account((port), (dir), (count), __io_start)
+
+#else
+
+#define IO_ACCOUNT_TOP_N    0
+#define IO_ACCOUNT_BEGIN()                  do {} while (0)
+#define IO_ACCOUNT_END(port, dir, count)    do {} while (0)
+
+static inline void io_account_report(unsigned int top_n __attribute__((unused))) {
+}
+
+#endif // CONFIG_IO_ACCOUNTING
+
 // i/o delay so that we don't have to implement it separately for
 // all pio devices.
 //
@@ -41,7 +82,8 @@
 //
 // NOTE: This function should only be used for delays until the point
 // we have working sleep() / interrupts and programmamble interrupt timer
-// initialised.
+// initialised. Everything else should use udelay()/ndelay() from
+// time/clock.h, those are in real time.
 //
 static inline void iodelay(unsigned short time) {
     do { asm volatile("nop"); } while (time--);
@@ -65,32 +107,53 @@ static inline uint32_t to_uint32_t(void *data) {
 // Basic cpu port i/o
 static inline unsigned char __attribute__((always_inline)) inb(unsigned short port) {
     unsigned char ret;
+    IO_ACCOUNT_BEGIN();
     asm volatile("in %0, %1":"=a"(ret):"dN"(port));
+    IO_ACCOUNT_END(port, io_account_read, 1);
     return ret;
 }
 
 static inline unsigned short __attribute__((always_inline)) inw(unsigned short port) {
     unsigned short ret;
+    IO_ACCOUNT_BEGIN();
     asm volatile("in %0, %1":"=a"(ret):"dN"(port));
+    IO_ACCOUNT_END(port, io_account_read, 1);
     return ret;
 }
 
 static inline unsigned int __attribute__((always_inline)) inl(unsigned short port) {
     unsigned int ret;
+    IO_ACCOUNT_BEGIN();
     asm volatile("in %0, %1":"=a"(ret):"dN"(port));
+    IO_ACCOUNT_END(port, io_account_read, 1);
     return ret;
 }
 
 static inline void __attribute__((always_inline, no_caller_saved_registers)) outb(unsigned char v, unsigned short port) {
+    IO_ACCOUNT_BEGIN();
     asm volatile("out %1, %0"::"a"(v),"dN"(port));
+    IO_ACCOUNT_END(port, io_account_write, 1);
 }
 
 static inline void __attribute__((always_inline, no_caller_saved_registers)) outw(unsigned short v, unsigned short port) {
+    IO_ACCOUNT_BEGIN();
     asm volatile("out %1, %0"::"a"(v),"dN"(port));
+    IO_ACCOUNT_END(port, io_account_write, 1);
 }
 
 static inline void __attribute__((always_inline, no_caller_saved_registers)) outl(unsigned int v, unsigned short port) {
+    IO_ACCOUNT_BEGIN();
     asm volatile("out %1, %0"::"a"(v),"dN"(port));
+    IO_ACCOUNT_END(port, io_account_write, 1);
+}
+
+// Write len bytes from buf to port with a single rep outsb, for
+// devices that don't need any pacing between bytes.
+static inline void __attribute__((always_inline)) outsb(unsigned short port, const void *buf, uint64_t len) {
+    uint64_t left = len;
+    IO_ACCOUNT_BEGIN();
+    asm volatile("rep outsb":"+S"(buf),"+c"(left):"d"(port):"memory");
+    IO_ACCOUNT_END(port, io_account_write, len);
 }
 
 #endif
@@ -0,0 +1,101 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2026, k4m1 <me@k4m1.net>
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+ 
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+ 
+ 3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __TINY_PROFILE_H__
+#define __TINY_PROFILE_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef CONFIG_PROFILE_HZ
+
+#include <time/timer.h>
+
+// 8 bytes a sample, 64k of heap. At 1000Hz that's 8 seconds of boot,
+// samples past that are counted as dropped.
+#define PROFILE_MAX_SAMPLES     8192
+
+/* Sampling profiler state
+ *
+ * @member uint64_t *samples     -- interrupted RIP per sample
+ * @member uint32_t count        -- samples taken
+ * @member uint32_t dropped      -- samples that didn't fit
+ * @member uint64_t rip          -- RIP last timer interrupt interrupted
+ * @member uint64_t period_ns    -- time between samples
+ * @member uint64_t next_ns      -- now_ns() value next sample is due
+ * @member timer sample_timer    -- timer taking samples
+ */
+typedef struct {
+    uint64_t *samples;
+    uint32_t count;
+    uint32_t dropped;
+    uint64_t rip;
+    uint64_t period_ns;
+    uint64_t next_ns;
+    timer sample_timer;
+} profile_state;
+
+extern profile_state profile;
+
+/* Allocate sample buffer and start sampling at CONFIG_PROFILE_HZ.
+ * Samples are taken from timer interrupt, so timers must be set up.
+ *
+ * @return bool true if profiler is running
+ */
+bool profile_init(void);
+
+/* Note where timer interrupt came in, called from timer interrupt 
+ * handlers before running timers.
+ *
+ * @param uint64_t rip -- RIP from interrupt stack frame
+ */
+static inline void __attribute__((no_caller_saved_registers)) profile_interrupted(uint64_t rip) {
+    profile.rip = rip;
+}
+
+/* Stop sampling and dump samples as "profile <rip> <count>" lines 
+ * for tools/profsym.py to symbolise.
+ */
+void profile_report(void);
+
+#else
+
+static inline bool profile_init(void) {
+    return false;
+}
+static inline void __attribute__((no_caller_saved_registers)) profile_interrupted(uint64_t rip __attribute__((unused))) {
+}
+static inline void profile_report(void) {
+}
+
+#endif // CONFIG_PROFILE_HZ
+
+#endif // __TINY_PROFILE_H__
@@ -0,0 +1,105 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2026, k4m1 <me@k4m1.net>
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+ 
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+ 
+ 3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __TINY_SPINLOCK_H__
+#define __TINY_SPINLOCK_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <cpu/common.h>
+
+/* Ticket spinlock. Each cpu takes a ticket and waits for its turn, 
+ * so lock is handed out in order it was asked for and nobody starves.
+ *
+ * @member uint32_t next  -- next ticket to hand out
+ * @member uint32_t owner -- ticket that holds the lock
+ */
+typedef struct {
+    volatile uint32_t next;
+    volatile uint32_t owner;
+} spinlock;
+
+#define SPINLOCK_INIT { .next = 0, .owner = 0 }
+
+static inline void spin_lock_init(spinlock *lock) {
+    lock->next = 0;
+    lock->owner = 0;
+}
+
+/* Take lock, spinning until it's our turn
+ *
+ * @param spinlock *lock -- lock to take
+ */
+static inline void spin_lock(spinlock *lock) {
+    uint32_t ticket = __atomic_fetch_add(&lock->next, 1, __ATOMIC_RELAXED);
+    while (__atomic_load_n(&lock->owner, __ATOMIC_ACQUIRE) != ticket) {
+        cpu_relax();
+    }
+}
+
+/* Take lock if nobody holds it or waits for it
+ *
+ * @param spinlock *lock -- lock to take
+ * @return bool true if we got it
+ */
+static inline bool spin_trylock(spinlock *lock) {
+    uint32_t owner = __atomic_load_n(&lock->owner, __ATOMIC_ACQUIRE);
+    uint32_t ticket = owner;
+    return __atomic_compare_exchange_n(&lock->next, &ticket, (owner + 1), false,
+            __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}
+
+static inline void spin_unlock(spinlock *lock) {
+    __atomic_store_n(&lock->owner, (lock->owner + 1), __ATOMIC_RELEASE);
+}
+
+/* Take lock with interrupts disabled, for locks interrupt handlers
+ * on this cpu may want too.
+ *
+ * @param spinlock *lock -- lock to take
+ * @return bool true if interrupts were enabled, for spin_unlock_irqrestore()
+ */
+static inline bool spin_lock_irqsave(spinlock *lock) {
+    bool int_enabled = interrupts_enabled();
+    cli();
+    spin_lock(lock);
+    return int_enabled;
+}
+
+static inline void spin_unlock_irqrestore(spinlock *lock, bool int_enabled) {
+    spin_unlock(lock);
+    if (int_enabled) {
+        sti();
+    }
+}
+
+#endif // __TINY_SPINLOCK_H__
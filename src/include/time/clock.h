@@ -0,0 +1,164 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2026, k4m1 <me@k4m1.net>
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+ 
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+ 
+ 3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __TINY_CLOCK_H__
+#define __TINY_CLOCK_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <cpu/common.h>
+
+#include <time/clocksource.h>
+
+// Until TSC is calibrated we pretend to run at 4GHz, that way early
+// delays come out too long rather than too short.
+#define CLOCK_FALLBACK_TSC_KHZ      4000000
+
+// Calibration: best of 3 runs of 10ms on PIT channel 2
+#define CLOCK_CALIBRATION_RUNS      3
+#define CLOCK_CALIBRATION_PIT_TICKS 11932
+
+// ns = (tsc ticks * ns_mult) >> CLOCK_NS_SHIFT
+#define CLOCK_NS_SHIFT              32
+#define CLOCK_NS_MULT(khz)          ((1000000ULL << CLOCK_NS_SHIFT) / (khz))
+
+/* Where we got TSC frequency from
+ *
+ * @member tsc_freq_fallback   -- nowhere, using CLOCK_FALLBACK_TSC_KHZ
+ * @member tsc_freq_mainboard  -- mainboard configuration told us
+ * @member tsc_freq_hypervisor -- hypervisor timing cpuid leaf
+ * @member tsc_freq_cpuid      -- crystal/base frequency cpuid leaves
+ * @member tsc_freq_pit        -- measured against PIT channel 2
+ */
+enum TSC_FREQ_SOURCE {
+    tsc_freq_fallback,
+    tsc_freq_mainboard,
+    tsc_freq_hypervisor,
+    tsc_freq_cpuid,
+    tsc_freq_pit
+};
+
+/* System clock state
+ *
+ * @member uint64_t tsc_khz                -- TSC frequency
+ * @member uint64_t ns_mult                -- TSC ticks to nanoseconds multiplier
+ * @member enum TSC_FREQ_SOURCE freq_source -- where tsc_khz came from
+ * @member bool tsc_timekeeping            -- now_ns() reads TSC directly, 
+ *                                            cleared if clocksource_init() 
+ *                                            picks something better
+ */
+typedef struct {
+    uint64_t tsc_khz;
+    uint64_t ns_mult;
+    enum TSC_FREQ_SOURCE freq_source;
+    bool tsc_timekeeping;
+} clock_state;
+
+extern clock_state system_clock;
+
+/* Find out TSC frequency. Mainboard configuration and cpuid are
+ * asked first, PIT calibration is only done if they don't know.
+ * Has to run before anything that needs accurate delays, and with 
+ * interrupts off.
+ *
+ * @return bool true if we know TSC frequency, false if we stay 
+ *              on the fallback frequency
+ */
+bool clock_init(void);
+
+/* Get name of where TSC frequency came from, for logging
+ *
+ * @param enum TSC_FREQ_SOURCE source -- frequency source
+ * @return const char * name
+ */
+const char *clock_freq_source_name(enum TSC_FREQ_SOURCE source);
+
+/* Convert TSC ticks to nanoseconds
+ *
+ * @param uint64_t ticks -- tsc ticks
+ * @return uint64_t nanoseconds
+ */
+static inline uint64_t clock_ticks_to_ns(uint64_t ticks) {
+    return (uint64_t)(((unsigned __int128)ticks * system_clock.ns_mult) >> CLOCK_NS_SHIFT);
+}
+
+/* Get monotonic time since reset
+ *
+ * @return uint64_t nanoseconds since reset
+ */
+static inline uint64_t now_ns(void) {
+    if (system_clock.tsc_timekeeping) {
+        return clock_ticks_to_ns(rdtsc());
+    }
+    return clocksource_now_ns();
+}
+
+/* Get TSC value given amount of microseconds from now
+ *
+ * @param uint32_t us -- microseconds from now
+ * @return uint64_t deadline for deadline_passed()
+ */
+static inline uint64_t deadline_us(uint32_t us) {
+    return (rdtsc() + (((uint64_t)us * system_clock.tsc_khz) / 1000));
+}
+
+/* Get TSC value given amount of nanoseconds from now
+ *
+ * @param uint32_t ns -- nanoseconds from now
+ * @return uint64_t deadline for deadline_passed()
+ */
+static inline uint64_t deadline_ns(uint32_t ns) {
+    return (rdtsc() + ((((uint64_t)ns * system_clock.tsc_khz) + 999999) / 1000000));
+}
+
+/* Check if deadline from deadline_us()/deadline_ns() has passed
+ *
+ * @param uint64_t deadline -- deadline to check
+ * @return bool true once we're past it
+ */
+static inline bool deadline_passed(uint64_t deadline) {
+    return (rdtsc() >= deadline);
+}
+
+/* Busy wait for given amount of nanoseconds
+ *
+ * @param uint32_t ns -- nanoseconds to wait
+ */
+void ndelay(uint32_t ns);
+
+/* Busy wait for given amount of microseconds
+ *
+ * @param uint32_t us -- microseconds to wait
+ */
+void udelay(uint32_t us);
+
+#endif // __TINY_CLOCK_H__
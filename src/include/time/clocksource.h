@@ -0,0 +1,132 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2026, k4m1 <me@k4m1.net>
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+ 
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+ 
+ 3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __TINY_CLOCKSOURCE_H__
+#define __TINY_CLOCKSOURCE_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <drivers/device.h>
+
+// Max amount of counters we know about
+#define CLOCKSOURCE_MAX             4
+// Reads we average over when measuring read cost
+#define CLOCKSOURCE_COST_SAMPLES    16
+
+// cycles to ns: ns = (cycles * ns_mult) >> CLOCKSOURCE_NS_SHIFT
+#define CLOCKSOURCE_NS_SHIFT        32
+
+// ACPI PM timer, 24-bit counter at offset 8 of pm i/o block
+#define ACPI_PM_TIMER_HZ            3579545
+#define ACPI_PM_TIMER_OFFSET        0x08
+#define ACPI_PM_TIMER_MASK          0x00FFFFFF
+
+// HPET registers
+#define HPET_REG_CAPABILITIES       0x000
+#define HPET_REG_CONFIG             0x010
+#define HPET_REG_COUNTER            0x0F0
+#define HPET_CAP_COUNT_SIZE_64      (1ULL << 13)
+#define HPET_CONFIG_ENABLE          0x01
+// Spec says counter period is at most 100ns, in femtoseconds
+#define HPET_MAX_PERIOD_FS          100000000ULL
+
+/* Free running counter we can tell time with
+ *
+ * Counters are narrower than 64 bits and wrap, so they're read 
+ * through clocksource_cycles() that extends them to 64 bits. That 
+ * has to happen at least once per wrap, timer interrupt does it.
+ *
+ * @member char *name                -- name for logging
+ * @member uint64_t (*read)          -- read raw counter value
+ * @member uint64_t base             -- i/o port or mmio address of counter
+ * @member uint64_t mask             -- counter width
+ * @member uint64_t freq_hz          -- counter frequency
+ * @member uint64_t ns_mult          -- cycles to ns multiplier
+ * @member uint32_t resolution_ns    -- length of one tick
+ * @member uint32_t read_cost_ns     -- how long a read takes
+ * @member uint64_t last             -- raw value at last read
+ * @member uint64_t cycles           -- 64-bit extended count at last read
+ * @member uint64_t base_ns          -- now_ns() when we started using this
+ */
+typedef struct clocksource {
+    char *name;
+    uint64_t (*read)(struct clocksource *cs);
+    uint64_t base;
+    uint64_t mask;
+    uint64_t freq_hz;
+    uint64_t ns_mult;
+    uint32_t resolution_ns;
+    uint32_t read_cost_ns;
+    uint64_t last;
+    uint64_t cycles;
+    uint64_t base_ns;
+} clocksource;
+
+/* Clocksource we're telling time with, NULL until clocksource_init()
+ * has picked one.
+ */
+extern clocksource *system_clocksource;
+
+/* Find counters we have, measure them and pick the best one for
+ * now_ns(). Best is the one with smallest of max(resolution, read cost).
+ *
+ * @param device **pci_devs -- pci devices we've found
+ * @param uint8_t count     -- amount of pci devices
+ * @return clocksource * we picked
+ */
+clocksource *clocksource_init(device **pci_devs, uint8_t count);
+
+/* Read clocksource and extend it to 64 bits
+ *
+ * @param clocksource *cs -- clocksource to read
+ * @return uint64_t cycles since we started reading it
+ */
+uint64_t clocksource_cycles(clocksource *cs);
+
+/* Get time since reset from system clocksource
+ *
+ * @return uint64_t nanoseconds since reset
+ */
+uint64_t clocksource_now_ns(void);
+
+/* Get longest time we can go without reading system clocksource
+ *
+ * @return uint64_t nanoseconds, UINT64_MAX if it doesn't wrap in practice
+ */
+uint64_t clocksource_max_idle_ns(void);
+
+/* Keep system clocksource from wrapping unnoticed, called from 
+ * timer interrupt.
+ */
+void __attribute__((no_caller_saved_registers)) clocksource_tick(void);
+
+#endif // __TINY_CLOCKSOURCE_H__
@@ -0,0 +1,100 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2026, k4m1 <me@k4m1.net>
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+ 
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+ 
+ 3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __TINY_TICK_H__
+#define __TINY_TICK_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Don't bother programming timer interrupts closer than this, they'd
+// be due by the time we return from interrupt anyway
+#define TICK_MIN_DELTA_NS       10000ULL
+// Window wakeups per second is averaged over
+#define TICK_STATS_WINDOW_NS    1000000000ULL
+
+/* One-shot timer interrupt source
+ *
+ * @member char *name             -- printable name
+ * @member void arm(delta_ns)     -- fire interrupt once after delta_ns
+ * @member uint64_t max_delta_ns  -- longest delay device can count
+ */
+typedef struct {
+    char *name;
+    void (*arm)(uint64_t delta_ns);
+    uint64_t max_delta_ns;
+} tick_device;
+
+/* Tick state
+ *
+ * @member tick_device *dev          -- device we use, NULL if none
+ * @member uint64_t armed_at         -- now_ns() value interrupt is due at
+ * @member uint64_t wakeups          -- times idle() has woken up
+ * @member uint64_t wakeups_per_sec  -- wakeups over last full window
+ * @member uint64_t window_start     -- now_ns() value window started at
+ * @member uint64_t window_wakeups   -- wakeups at start of window
+ */
+typedef struct {
+    tick_device *dev;
+    uint64_t armed_at;
+    uint64_t wakeups;
+    uint64_t wakeups_per_sec;
+    uint64_t window_start;
+    uint64_t window_wakeups;
+} tick_state;
+
+extern tick_state ticks;
+
+/* Pick one-shot timer interrupt source, local apic timer if there's
+ * one, PIT otherwise, and arm it for first pending timer.
+ *
+ * @return bool true if we have a tick device
+ */
+bool tick_init(void);
+
+/* Make sure timer interrupt comes no later than given deadline,
+ * called with interrupts disabled when timers are armed.
+ *
+ * @param uint64_t deadline -- now_ns() value
+ */
+void __attribute__((no_caller_saved_registers)) tick_update(uint64_t deadline);
+
+/* Run clocksource and timers, and arm interrupt for next deadline.
+ * Called from timer interrupt handler, which sends EOI.
+ */
+void __attribute__((no_caller_saved_registers)) tick_handle_interrupt(void);
+
+/* Sleep until next interrupt, timer interrupt is programmed for 
+ * first pending timer so this may sleep for long.
+ */
+void idle(void);
+
+#endif // __TINY_TICK_H__
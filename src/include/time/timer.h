@@ -0,0 +1,121 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2026, k4m1 <me@k4m1.net>
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+ 
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+ 
+ 3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __TINY_TIMER_H__
+#define __TINY_TIMER_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Wheel granularity, timers fire on first tick at or after deadline
+#define TIMER_TICK_NS       1000000ULL
+
+// 4 levels of 64 slots, level N slot spans 64^N ticks. That covers
+// 64^4 ticks, about 4.6 hours, anything further out is parked in 
+// the last level until it comes within range.
+#define TIMER_WHEEL_BITS    6
+#define TIMER_WHEEL_SLOTS   (1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_MASK    (TIMER_WHEEL_SLOTS - 1)
+#define TIMER_WHEEL_LEVELS  4
+#define TIMER_WHEEL_RANGE   (1ULL << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS))
+
+typedef void (*timer_callback)(void *arg);
+
+/* Doubly linked list node, slots of the wheel are circular lists 
+ * with the slot itself as head.
+ */
+typedef struct timer_list {
+    struct timer_list *next;
+    struct timer_list *prev;
+} timer_list;
+
+/* Timer, storage is provided by whoever arms it. Callback runs from 
+ * timer interrupt with interrupts disabled, it may re-arm the timer.
+ *
+ * @member timer_list node     -- wheel slot we're on
+ * @member uint64_t expires    -- tick to fire at
+ * @member timer_callback cb   -- function to call
+ * @member void *arg           -- argument to pass to callback
+ * @member bool pending        -- armed and not fired yet
+ */
+typedef struct {
+    timer_list node;
+    uint64_t expires;
+    timer_callback cb;
+    void *arg;
+    bool pending;
+} timer;
+
+/* Timer wheel state
+ *
+ * @member timer_list slot[][] -- timers waiting, per level and slot
+ * @member uint64_t tick       -- next tick to process
+ */
+typedef struct {
+    timer_list slot[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+    uint64_t tick;
+} timer_wheel;
+
+/* Set up timer wheel, timers can't be armed before this.
+ *
+ * @return bool true on success, false if we're out of memory
+ */
+bool timer_init(void);
+
+/* Arm a timer. Timer that's already pending gets moved to new deadline.
+ *
+ * @param timer *t            -- timer to arm
+ * @param uint64_t deadline   -- now_ns() value to fire at
+ * @param timer_callback cb   -- function to call
+ * @param void *arg           -- argument to pass to callback
+ * @return bool true if timer was armed
+ */
+bool timer_add(timer *t, uint64_t deadline, timer_callback cb, void *arg);
+
+/* Disarm a timer
+ *
+ * @param timer *t -- timer to cancel
+ * @return bool true if timer was pending
+ */
+bool timer_cancel(timer *t);
+
+/* Get time at which wheel next needs timer_run(), for programming
+ * one-shot timer interrupt. Cascades count too, so this may be early.
+ *
+ * @return uint64_t now_ns() value, UINT64_MAX if nothing is pending
+ */
+uint64_t timer_next_deadline(void);
+
+/* Fire every timer that's due, called from timer interrupt. 
+ */
+void __attribute__((no_caller_saved_registers)) timer_run(void);
+
+#endif // __TINY_TIMER_H__
@@ -0,0 +1,122 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2026, k4m1 <me@k4m1.net>
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+ 
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+ 
+ 3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __TINY_TIMESTAMP_H__
+#define __TINY_TIMESTAMP_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <mainboards/memory_init.h>
+
+/* Boot timestamp table
+ *
+ * TSC is recorded at fixed points of boot into a table at fixed 
+ * address in low memory, reported as reserved in memory map so that
+ * OS can find it by signature and read it. Stamps before c_main() 
+ * are kept in MMX registers, there's no memory to put them in yet.
+ * Table ends where EBDA starts at 0x9FC00.
+ */
+#define TIMESTAMP_BASE          0x0009F000
+#define TIMESTAMP_SIZE          0x00000C00
+#define TIMESTAMP_SIGNATURE     "TBIOSTS"
+#define TIMESTAMP_VERSION       1
+#define TIMESTAMP_TAG_LEN       20
+
+enum TIMESTAMP_ID {
+    ts_reset,
+    ts_car_up,
+    ts_memory_up,
+    ts_c_main,
+    ts_device_start,
+    ts_device_end,
+    ts_pci_start,
+    ts_pci_end,
+    ts_ata_start,
+    ts_ata_end,
+    ts_post_done
+};
+
+/* One timestamp
+ *
+ * @member uint64_t tsc   -- TSC value
+ * @member uint32_t id    -- enum TIMESTAMP_ID
+ * @member char tag[]     -- what, such as device name, nul padded
+ */
+typedef struct __attribute__((packed)) {
+    uint64_t tsc;
+    uint32_t id;
+    char tag[TIMESTAMP_TAG_LEN];
+} timestamp_entry;
+
+/* Header at start of table
+ *
+ * @member char signature[8]  -- TIMESTAMP_SIGNATURE
+ * @member uint16_t version   -- TIMESTAMP_VERSION
+ * @member uint16_t count     -- entries recorded
+ * @member uint16_t max       -- entries that fit
+ * @member uint16_t dropped   -- entries that didn't fit
+ * @member uint64_t tsc_khz   -- TSC frequency, 0 until known
+ * @member timestamp_entry entry[]
+ */
+typedef struct __attribute__((packed)) {
+    char signature[8];
+    uint16_t version;
+    uint16_t count;
+    uint16_t max;
+    uint16_t dropped;
+    uint64_t tsc_khz;
+    timestamp_entry entry[];
+} timestamp_table;
+
+/* Set up timestamp table and move stamps taken before we had memory
+ * from MMX registers into it. First thing c_main() does.
+ */
+void timestamp_init(void);
+
+/* Record TSC for a boot milestone
+ *
+ * @param enum TIMESTAMP_ID id -- milestone
+ * @param const char *tag      -- what it's about, NULL for nothing
+ */
+void timestamp(enum TIMESTAMP_ID id, const char *tag);
+
+/* Add timestamp table to memory map as reserved
+ *
+ * @param memory_map *map -- memory map to add region to
+ */
+void timestamp_reserve(memory_map *map);
+
+/* Print how long each stage took and how much of total boot time
+ */
+void timestamp_report(void);
+
+#endif // __TINY_TIMESTAMP_H__
@@ -0,0 +1,173 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2026, k4m1 <me@k4m1.net>
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+ 
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+ 
+ 3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <console/console.h>
+#include <panic.h>
+
+#include <init_graph.h>
+#include <stacks/task.h>
+#include <time/clock.h>
+
+static void init_step_entry(void *arg) {
+    init_step *step = arg;
+    step->run();
+    step->end_ns = now_ns();
+    step->state = init_step_done;
+}
+
+/* Check if all dependencies of a step are done, and note which one
+ * finished last, that's what the step was waiting for.
+ *
+ * @param init_step *steps -- all steps
+ * @param init_step *step  -- step to check
+ * @return bool true if step can run
+ */
+static bool init_step_ready(init_step *steps, init_step *step) {
+    step->critical_dep = -1;
+    step->ready_ns = 0;
+    for (int8_t dep = 0; dep < INIT_MAX_STEPS; dep++) {
+        if ((step->deps & INIT_DEP(dep)) == 0) {
+            continue;
+        }
+        if (steps[dep].state != init_step_done) {
+            return false;
+        }
+        if (steps[dep].end_ns >= step->ready_ns) {
+            step->ready_ns = steps[dep].end_ns;
+            step->critical_dep = dep;
+        }
+    }
+    return true;
+}
+
+/* Walk back from step that finished last through dependencies that
+ * held each step back. Time spent waiting for a free task slot shows
+ * as gap between ready and start.
+ *
+ * @param init_step *steps -- all steps
+ * @param uint8_t count    -- amount of steps
+ * @param uint64_t start   -- now_ns() when we started
+ */
+static void init_graph_report(init_step *steps, uint8_t count, uint64_t start) {
+    int8_t last = 0;
+    for (uint8_t i = 1; i < count; i++) {
+        if (steps[i].end_ns > steps[last].end_ns) {
+            last = i;
+        }
+    }
+    uint64_t serial_ns = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        serial_ns += (steps[i].end_ns - steps[i].start_ns);
+    }
+    blogf("Init took %lu us, steps add up to %lu us. Critical path:\n",
+            ((steps[last].end_ns - start) / 1000), (serial_ns / 1000));
+    for (int8_t i = last; i >= 0; i = steps[i].critical_dep) {
+        init_step *step = &steps[i];
+        uint64_t ready = step->ready_ns ? step->ready_ns : start;
+        blogf("  %-12s %8lu us, waited %lu us to start\n", step->name, 
+                ((step->end_ns - step->start_ns) / 1000),
+                ((step->start_ns - ready) / 1000));
+    }
+}
+
+/* Run steps in dependency order, independent ones concurrently, and
+ * report the chain of steps that bounded total time. Returns once all
+ * steps are done. Panics on dependency cycles.
+ *
+ * @param init_step *steps -- steps to run
+ * @param uint8_t count    -- amount of steps, at most INIT_MAX_STEPS
+ */
+void init_graph_run(init_step *steps, uint8_t count) {
+    if ((count == 0) || (count > INIT_MAX_STEPS)) {
+        return;
+    }
+    uint32_t valid = (count == INIT_MAX_STEPS) ? ~0U : (INIT_DEP(count) - 1);
+    for (uint8_t i = 0; i < count; i++) {
+        if (steps[i].deps & ~valid) {
+            panic("init step %s depends on unknown step\n", steps[i].name);
+        }
+        steps[i].state = init_step_waiting;
+    }
+
+    uint64_t start = now_ns();
+    uint8_t done = 0;
+    while (done < count) {
+        uint8_t running = 0;
+        done = 0;
+        for (uint8_t i = 0; i < count; i++) {
+            if (steps[i].state == init_step_running) {
+                running++;
+            } else if (steps[i].state == init_step_done) {
+                done++;
+            }
+        }
+        for (uint8_t i = 0; (i < count) && (running < INIT_MAX_TASKS); i++) {
+            init_step *step = &steps[i];
+            if ((step->state != init_step_waiting) || !init_step_ready(steps, step)) {
+                continue;
+            }
+            step->state = init_step_running;
+            step->start_ns = now_ns();
+            if (task_spawn(step->name, init_step_entry, step)) {
+                running++;
+            } else {
+                init_step_entry(step);
+            }
+        }
+        if (done == count) {
+            break;
+        }
+        if (running == 0) {
+            // Nothing running, so something must be ready to start 
+            // unless steps wait on each other
+            uint8_t pending = 0;
+            bool progress = false;
+            for (uint8_t i = 0; i < count; i++) {
+                if (steps[i].state == init_step_done) {
+                    continue;
+                }
+                pending++;
+                if (init_step_ready(steps, &steps[i])) {
+                    progress = true;
+                }
+            }
+            if (pending && !progress) {
+                panic("init steps depend on each other in a loop\n");
+            }
+        }
+        yield();
+    }
+    init_graph_report(steps, count, start);
+}
@@ -33,6 +33,7 @@
 #include <interrupts/idt.h>
 #include <drivers/pic_8259/pic.h>
 #include <cpu/common.h>
+#include <sys/spinlock.h>
 
 #include <stdint.h>
 #include <string.h>
@@ -59,28 +60,33 @@ void init_idt(void) {
 }
 
 
+// APs share our idt, entries are built aside and copied in under lock
+static spinlock idt_lock = SPINLOCK_INIT;
+
 /* Add a new interrupt handler to idt
  *
  * @param uint64_t entry   -- Which interrupt entry is this 
  * @param uint64_t handler -- Address to interrupt handler to register
  */
 void add_interrupt_handler(uint64_t entry, uint64_t handler) {
-
-    memset((void *)&idt->entry[entry], 0, sizeof(idt_entry));
+    idt_entry new_entry = {0};
 
     uint16_t lo = (uint16_t)handler;
     uint16_t mi = (uint16_t)(handler >> 16);
     uint32_t hi = (uint32_t)(handler >> 32);
 
-    idt->entry[entry].segment.privilege = 0;
-    idt->entry[entry].segment.use_ldt = 0;
-    idt->entry[entry].segment.index = 0x10;
+    new_entry.segment.privilege = 0;
+    new_entry.segment.use_ldt = 0;
+    new_entry.segment.index = 0x10;
 
-    idt->entry[entry].offset_low = lo;
-    idt->entry[entry].offset_mid = mi;
-    idt->entry[entry].offset_high = hi;
-    idt->entry[entry].present = 1;
-    idt->entry[entry].int_gate_type = 0x0E; 
+    new_entry.offset_low = lo;
+    new_entry.offset_mid = mi;
+    new_entry.offset_high = hi;
+    new_entry.present = 1;
+    new_entry.int_gate_type = 0x0E; 
 
+    bool int_enabled = spin_lock_irqsave(&idt_lock);
+    idt->entry[entry] = new_entry;
+    spin_unlock_irqrestore(&idt_lock, int_enabled);
 }
 
@@ -44,6 +44,21 @@
 
 #include <console/console.h>
 
+#include <mm/paging.h>
+
+/**
+ * Get i/o port of bochs vbe registers.
+ *
+ * @param pdev Is the pci device data of vga device.
+ * @return index port, data port is one above it.
+ */
+static uint16_t bochs_vbe_base(pci_device_data *pdev) {
+    if (pdev->device_hdr.bar2) {
+        return pdev->device_hdr.bar2;
+    }
+    return bochs_vbe_ioidx;
+}
+
 /**
  * Enable and initialise bochs framebuffer.
  *
@@ -52,13 +67,7 @@
  */
 enum DEVICE_STATUS init_vga_controller(device *vgadev) {
     pci_device_data *pdev = vgadev->device_data;
-
-    uint16_t base;
-    if (pdev->device_hdr.bar2) {
-        base = pdev->device_hdr.bar2;
-    } else {
-        base = bochs_vbe_ioidx;
-    }
+    uint16_t base = bochs_vbe_base(pdev);
 
     uint16_t ver = bochs_vbe_version(base);
     if (ver < 0xB0C0 || ver > 0xB0C5) {
@@ -68,17 +77,61 @@ enum DEVICE_STATUS init_vga_controller(device *vgadev) {
     bochs_vbe_disable(base);
     bochs_vbe_out(base, 0, bochs_vbe_idx_bank);
     bochs_vbe_out(base, 32, bochs_vbe_idx_bpp);
-    bochs_vbe_out(base, 760, bochs_vbe_idx_xres);
-    bochs_vbe_out(base, 480, bochs_vbe_idx_yres);
-    bochs_vbe_out(base, 760, bochs_vbe_idx_v_width);
-    bochs_vbe_out(base, 480, bochs_vbe_idx_v_height);
+    bochs_vbe_out(base, bochs_fb_xres, bochs_vbe_idx_xres);
+    bochs_vbe_out(base, bochs_fb_yres, bochs_vbe_idx_yres);
+    bochs_vbe_out(base, bochs_fb_xres, bochs_vbe_idx_v_width);
+    // Ask for room for two screens, fbcon pans over it to scroll
+    bochs_vbe_out(base, (2 * bochs_fb_yres), bochs_vbe_idx_v_height);
     bochs_vbe_out(base, 0, bochs_vbe_idx_x_off);
     bochs_vbe_out(base, 0, bochs_vbe_idx_y_off);
     bochs_vbe_out(base, (0x40 | 0x01), bochs_vbe_idx_enable);
-    outb(0x20, (base + 0x03c0));
-    pci_write_config(&pdev->address, 0x10, 0x1000008);
+    outb(0x20, 0x03c0);
+
+    // Framebuffer has to be above end of ram, and memory decoding
+    // enabled for us to see it.
+    pci_write_config(&pdev->address, 0x10, (bochs_fb_addr | 0x08));
+    uint32_t cmd = pci_read_config(&pdev->address, 0x04);
+    pci_write_config(&pdev->address, 0x04, ((cmd & 0xFFFF) | 0x03));
 
     return status_initialised;
 }
 
+/**
+ * Set first visible scanline of bochs framebuffer.
+ *
+ * @param vgadev Is the vga device.
+ * @param y Is the scanline to show on top of screen.
+ */
+void bochs_fb_pan(device *vgadev, uint32_t y) {
+    uint16_t base = bochs_vbe_base(vgadev->device_data);
+    bochs_vbe_out(base, (uint16_t)y, bochs_vbe_idx_y_off);
+}
+
+/**
+ * Describe initialised bochs framebuffer for fbcon.
+ *
+ * @param vgadev Is the vga device.
+ * @param fb Is the framebuffer structure to fill in.
+ * @return true if framebuffer is usable.
+ */
+bool bochs_fb_describe(device *vgadev, framebuffer *fb) {
+    if (vgadev->status != status_initialised) {
+        return false;
+    }
+    uint16_t base = bochs_vbe_base(vgadev->device_data);
+
+    fb->base = (uint32_t *)(uint64_t)bochs_fb_addr;
+    fb->width = bochs_vbe_in(base, bochs_vbe_idx_xres);
+    fb->height = bochs_vbe_in(base, bochs_vbe_idx_yres);
+    fb->pitch = bochs_vbe_in(base, bochs_vbe_idx_v_width);
+    // Virtual height is derived from video memory size, it's not
+    // necessarily what we asked for
+    fb->virt_height = bochs_vbe_in(base, bochs_vbe_idx_v_height);
+    fb->hw = vgadev;
+    fb->pan = bochs_fb_pan;
+
+    uint64_t size = ((uint64_t)fb->pitch * fb->virt_height * sizeof(uint32_t));
+    return map_address(fb->base, ((size + 0xFFF) & ~0xFFFULL));
+}
+
 
@@ -0,0 +1,69 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2026, k4m1 <me@k4m1.net>
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+ 
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+ 
+ 3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <mainboards/qemu/chipset.h>
+
+#include <drivers/device.h>
+#include <drivers/pci/pci.h>
+#include <drivers/pci/pci_util.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Enable ACPI power management i/o block of whichever chipset we're on
+ *
+ * @param device **pci_devs -- pci devices we've found
+ * @param uint8_t count     -- amount of pci devices
+ * @return uint16_t base of pm i/o block, or 0 if chipset is unknown
+ */
+uint16_t qemu_acpi_pm_enable(device **pci_devs, uint8_t count) {
+    for (uint8_t i = 0; i < count; i++) {
+        pci_device_data *pdev = pci_devs[i]->device_data;
+        uint16_t vendor = pdev->generic_header_fields.vendor_id;
+        uint16_t devid = pdev->generic_header_fields.device_id;
+
+        if ((vendor == piix4_pm_vendor_id) && (devid == piix4_pm_device_id)) {
+            pci_write_config(&pdev->address, piix4_pm_reg_pmba, (qemu_acpi_pm_base | 0x01));
+            uint32_t misc = pci_read_config(&pdev->address, piix4_pm_reg_pmregmisc);
+            pci_write_config(&pdev->address, piix4_pm_reg_pmregmisc, 
+                    (misc | PIIX4_PMREGMISC_PMIOSE));
+            return qemu_acpi_pm_base;
+        }
+        if ((vendor == ich9_lpc_vendor_id) && (devid == ich9_lpc_device_id)) {
+            pci_write_config(&pdev->address, ich9_lpc_reg_pmbase, (qemu_acpi_pm_base | 0x01));
+            uint32_t cntl = pci_read_config(&pdev->address, ich9_lpc_reg_acpi_cntl);
+            pci_write_config(&pdev->address, ich9_lpc_reg_acpi_cntl, 
+                    (cntl | ICH9_ACPI_CNTL_ACPI_EN));
+            return qemu_acpi_pm_base;
+        }
+    }
+    return 0;
+}
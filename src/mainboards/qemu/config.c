@@ -0,0 +1,155 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2026, k4m1 <me@k4m1.net>
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+ 
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+ 
+ 3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <mainboards/config.h>
+#include <mainboards/qemu/fwcfg/fwcfg.h>
+#include <mainboards/qemu/bochsfb.h>
+#include <mainboards/qemu/chipset.h>
+
+#include <drivers/device.h>
+#include <drivers/pci/pci.h>
+#include <drivers/fbcon/fbcon.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Parse a decimal number out of a fw-cfg string file, such as one 
+ * given with -fw_cfg name=opt/tinybios/baudrate,string=115200
+ *
+ * @param char *name -- fw-cfg file to read
+ * @return uint32_t value, or 0 if file is missing or not a number
+ */
+static uint32_t fwcfg_read_decimal(char *name) {
+    char buf[16] = {0};
+    uint32_t len = fwcfg_read_file_into(name, buf, (sizeof(buf) - 1));
+    uint32_t ret = 0;
+
+    for (uint32_t i = 0; i < len; i++) {
+        if ((buf[i] < '0') || (buf[i] > '9')) {
+            break;
+        }
+        ret = (ret * 10) + (buf[i] - '0');
+    }
+    return ret;
+}
+
+/* Get baud rate to use for the primary uart
+ *
+ * @return uint32_t baud rate, or 0 if not configured
+ */
+uint32_t mainboard_uart_baudrate(void) {
+    if (qemu_fwcfg_present() == false) {
+        return 0;
+    }
+    return fwcfg_read_decimal("opt/tinybios/baudrate");
+}
+
+/* Get port of ISA debug console. qemu doesn't tell if -debugcon was
+ * given, so this is only for setups where debugcon has been moved 
+ * away from 0xE9 or has readback disabled.
+ *
+ * @return uint16_t port, or 0 if not configured
+ */
+uint16_t mainboard_debugcon_port(void) {
+    if (qemu_fwcfg_present() == false) {
+        return 0;
+    }
+    return (uint16_t)fwcfg_read_decimal("opt/tinybios/debugcon");
+}
+
+/* Get TSC frequency. Management layers that pin guest TSC frequency
+ * can pass it in with -fw_cfg name=opt/tinybios/tsc_khz,string=N
+ * so that we don't need to ask cpuid or calibrate.
+ *
+ * @return uint32_t TSC frequency in kHz, or 0 if not configured
+ */
+uint32_t mainboard_tsc_khz(void) {
+    if (qemu_fwcfg_present() == false) {
+        return 0;
+    }
+    return fwcfg_read_decimal("opt/tinybios/tsc_khz");
+}
+
+/* Find and set up a display we can draw a console on. On qemu that's
+ * bochs/std vga.
+ *
+ * @param device **pci_devs -- pci devices we've found
+ * @param uint8_t count     -- amount of pci devices
+ * @param framebuffer *fb   -- framebuffer description to fill in
+ * @return bool true if there's a framebuffer to use
+ */
+bool mainboard_framebuffer(device **pci_devs, uint8_t count, framebuffer *fb) {
+    for (uint8_t i = 0; i < count; i++) {
+        pci_device_data *pdev = pci_devs[i]->device_data;
+        if ((pdev->generic_header_fields.vendor_id != bochs_vga_vendor_id) ||
+            (pdev->generic_header_fields.device_id != bochs_vga_device_id)) {
+            continue;
+        }
+        initialize_device(init_vga_controller, pci_devs[i], "bochs/VGA", false);
+        return bochs_fb_describe(pci_devs[i], fb);
+    }
+    return false;
+}
+
+/* Enable ACPI power management registers and tell where they are
+ *
+ * @param device **pci_devs -- pci devices we've found
+ * @param uint8_t count     -- amount of pci devices
+ * @return uint16_t pm i/o base, or 0 if there's none
+ */
+uint16_t mainboard_acpi_pm_base(device **pci_devs, uint8_t count) {
+    return qemu_acpi_pm_enable(pci_devs, count);
+}
+
+/* Get address of HPET registers. Both i440fx and q35 have it at 
+ * the default address unless it's been disabled with -no-hpet, 
+ * caller has to check it's really there.
+ *
+ * @return uint64_t HPET base address, or 0 if there's none
+ */
+uint64_t mainboard_hpet_base(void) {
+    return qemu_hpet_base;
+}
+
+/* Get amount of cpus, boot cpu included. That's what -smp said, 
+ * hotpluggable ones not present yet are not counted.
+ *
+ * @return uint32_t cpu count, or 0 if mainboard doesn't know
+ */
+uint32_t mainboard_cpu_count(void) {
+    if (qemu_fwcfg_present() == false) {
+        return 0;
+    }
+    uint16_t count = 0;
+    qemu_fwcfg_select(fwcfg_nb_cpus);
+    qemu_fwcfg_insb((uint8_t *)&count, sizeof(count));
+    return count;
+}
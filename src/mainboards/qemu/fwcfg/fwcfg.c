@@ -58,17 +58,14 @@ bool qemu_fwcfg_present(void) {
     return (*sign == 0x554D4551);
 }
 
-/* Find a file from qemu fw-cfg list
+/* Look up a file from qemu fw-cfg list without complaining if
+ * it's not there.
  *
- * @param char *name -- Name of file we're searching for
- * @return pointer to fwcfg_file on success or NULL on error.
+ * @param char *name        -- Name of file we're searching for
+ * @param fwcfg_file *file  -- Where to store the directory entry
+ * @return bool true if file was found
  */
-fwcfg_file *fwcfg_find_file_entry(char *name) {
-    fwcfg_file *file = calloc(1, sizeof(fwcfg_file));
-    if (!file) {
-        blog("Failed to allocate memory for fwcfg_file!\n");
-        return NULL;
-    }
+static bool fwcfg_lookup_file(char *name, fwcfg_file *file) {
     uint32_t cnt = 0;
     qemu_fwcfg_select(fwcfg_file_dir);
     qemu_fwcfg_insb((uint8_t *)&cnt, sizeof(uint32_t));
@@ -79,13 +76,53 @@ fwcfg_file *fwcfg_find_file_entry(char *name) {
         if (strncmp((uint8_t *)file->name, (uint8_t *)name, sizeof(file->name)) == 0) {
             file->select = bswap_16(file->select);
             file->size = bswap_32(file->size);
-            return file;
+            return true;
         }
     }
-    blogf("QEMU FW-CFG Interface present but missing file '%s'\n", name);
+    return false;
+}
+
+/* Find a file from qemu fw-cfg list
+ *
+ * @param char *name -- Name of file we're searching for
+ * @return pointer to fwcfg_file on success or NULL on error.
+ */
+fwcfg_file *fwcfg_find_file_entry(char *name) {
+    fwcfg_file *file = calloc(1, sizeof(fwcfg_file));
+    if (!file) {
+        blog("Failed to allocate memory for fwcfg_file!\n");
+        return NULL;
+    }
+    if (fwcfg_lookup_file(name, file)) {
+        return file;
+    }
+    blogf_warning("QEMU FW-CFG Interface present but missing file '%s'\n", name);
+    free(file);
     return NULL;
 }
 
+/* Read up to size bytes of a fw-cfg file into a caller provided
+ * buffer. Missing files are not an error here, this is meant for
+ * optional configuration knobs.
+ *
+ * @param char *name    -- Name of file to read
+ * @param void *dst     -- Where to read the file to
+ * @param uint32_t size -- Size of dst
+ * @return uint32_t amount of bytes read, 0 if file is not there
+ */
+uint32_t fwcfg_read_file_into(char *name, void *dst, uint32_t size) {
+    fwcfg_file file;
+    if (fwcfg_lookup_file(name, &file) == false) {
+        return 0;
+    }
+    if (file.size < size) {
+        size = file.size;
+    }
+    qemu_fwcfg_select(file.select);
+    qemu_fwcfg_insb((uint8_t *)dst, size);
+    return size;
+}
+
 /* Read a file from qemu fw-cfg files
  *
  * @param fwcfg_file *file -- Pointer to populated fwcfg structure
@@ -63,7 +63,7 @@ bool mainboard_specific_memory_init(device *dev) {
         blog("Missing 'etc/e820 file from qemu fw-cfg\n");
         return false;
     }
-    blogf("Found '%s', parsing memory map\n", f->name);
+    blogf_debug("Found '%s', parsing memory map\n", f->name);
     qemu_fwcfg_select(f->select);
     uint32_t pos = 0;
     while (pos < f->size) {
@@ -36,9 +36,35 @@
 #include <string.h>
 
 #include <panic.h>
+#include <cpu/percpu.h>
+#include <sys/spinlock.h>
 
 extern heap_start *heap;
 
+// Per cpu arenas, carved out of main heap
+static heap_start *heap_arenas[HEAP_MAX_ARENAS];
+static uint32_t heap_arena_count = 0;
+
+bool heap_cache_enabled = true;
+
+/**
+ * Set up a heap or arena as one big free block.
+ *
+ * @param h Is the heap to set up
+ * @param start Is where the first block goes
+ * @param size Tells the amount of bytes from start we can use
+ */
+static void heap_setup(heap_start *h, memory_header *start, uint64_t size) {
+    h->start = start;
+    h->size  = size;
+    h->start->free = true;
+    h->start->cached = false;
+    h->start->size = size - sizeof(memory_header);
+    h->start->previous = NULL;
+    h->start->next = NULL;
+    spin_lock_init(&h->lock);
+}
+
 /**
  * Initialise heap-space for us to use with malloc and co.
  *
@@ -46,45 +72,44 @@ extern heap_start *heap;
  * @param size Tells the amount of bytes we can use
  */
 void heap_init(uint64_t start, uint64_t size) {
-    heap->start = (memory_header *)start + sizeof(heap_start);
-    heap->size  = size;
-    heap->start->free = true;
-    heap->start->size = size - sizeof(memory_header);
-    heap->start->previous = NULL;
-    heap->start->next = NULL;
+    memory_header *first = (memory_header *)start + sizeof(heap_start);
+    heap_setup(heap, first, (size - ((uint64_t)first - start)));
 }
 
 /**
  * Helper to check if the given memory header address is valid.
  *
+ * @param h Is the heap we're working with.
  * @param memory_header Is the memory header we're working with.
  * @return true if the header address is valid
  */
-static bool hdr_addr_is_valid(memory_header *hdr) {
+static bool hdr_addr_is_valid(heap_start *h, memory_header *hdr) {
     uint64_t check = (uint64_t)hdr;
-    uint64_t start = (uint64_t)heap->start;
-    uint64_t end   = start + heap->size - sizeof(memory_header);
-    return (check < end);
+    uint64_t start = (uint64_t)h->start;
+    uint64_t end   = start + h->size - sizeof(memory_header);
+    return (check >= start) && (check < end);
 }
 
 /**
  * Helper to check if the next memory header is out of bounds
  *
+ * @param h Is the heap we're working with.
  * @param memory_header Is the memory header we're working with.
  * @return true if the next header is valid
  */
-static bool __attribute__((always_inline)) next_hdr_is_valid(memory_header *hdr) {
-    return hdr_addr_is_valid(hdr->next);
+static bool __attribute__((always_inline)) next_hdr_is_valid(heap_start *h, memory_header *hdr) {
+    return hdr_addr_is_valid(h, hdr->next);
 }
 
 /**
  * Helper to check if the previous memory header is out of bounds
  *
+ * @param h Is the heap we're working with.
  * @param memory_header Is the memory header we're working with.
  * @return true if the previous header is valid
  */
-static bool __attribute__((always_inline)) previous_hdr_is_valid(memory_header *hdr) {
-    return hdr_addr_is_valid(hdr->previous);
+static bool __attribute__((always_inline)) previous_hdr_is_valid(heap_start *h, memory_header *hdr) {
+    return hdr_addr_is_valid(h, hdr->previous);
 }
 
 /**
@@ -98,6 +123,25 @@ static memory_header * __attribute__((always_inline)) header_for_ptr(void *p) {
     return (memory_header *)(((uint64_t)p) - sizeof(memory_header));
 }
 
+/**
+ * Find heap or arena a pointer was allocated from. Arenas live 
+ * inside main heap, so they're checked first.
+ *
+ * @param p Is pointer to beginning of allocated memory.
+ * @return Pointer to heap_start of the owner.
+ */
+static heap_start *heap_for_ptr(void *p) {
+    uint64_t addr = (uint64_t)p;
+    uint32_t count = __atomic_load_n(&heap_arena_count, __ATOMIC_ACQUIRE);
+    for (uint32_t i = 0; i < count; i++) {
+        uint64_t start = (uint64_t)heap_arenas[i]->start;
+        if ((addr >= start) && (addr < (start + heap_arenas[i]->size))) {
+            return heap_arenas[i];
+        }
+    }
+    return heap;
+}
+
 /**
  * Get rounded-up size for malloc so that the linked list entries
  * are aligned for at least somewhat reasonably fast memory access I guess
@@ -125,17 +169,14 @@ static void * __attribute__((always_inline)) ptr_for_header(memory_header *hdr)
 /**
  * Helper to combine two consecutive memory blocks together.
  *
- * @param a Is a pointer to a free memory header.
- * @param b Is a pointer to, *drumroll*, a free memory header.
+ * @param h Is the heap we're working with.
+ * @param first Is a pointer to a free memory header.
+ * @param second Is a pointer to, *drumroll*, the free memory header right after it.
  */
-static void fuse_blocks(memory_header *a, memory_header *b) {
-    memory_header *first, *second;
-    first  = (a > b) ? a : b;
-    second = (a > b) ? b : a;
-
+static void fuse_blocks(heap_start *h, memory_header *first, memory_header *second) {
     first->size += second->size;
     first->next = second->next;
-    if (next_hdr_is_valid(first->next)) {
+    if (next_hdr_is_valid(h, first)) {
         first->next->previous = first;
     }
     memset(second, 0, sizeof(memory_header));
@@ -145,34 +186,38 @@ static void fuse_blocks(memory_header *a, memory_header *b) {
  * Helper to walk through our heap linked list from a given 
  * starting location and fuse together consecutive free blocks.
  *
+ * @param h Is the heap we're working with.
  * @param hdr Is a pointer to the starting point of our walkthrough
  */
-static void fuse_walkthrough(memory_header *hdr) {
-    while (next_hdr_is_valid(hdr)) {
+static void fuse_walkthrough(heap_start *h, memory_header *hdr) {
+    while (next_hdr_is_valid(h, hdr)) {
         if (hdr->next->free == false) {
             break;
         }
-        fuse_blocks(hdr, hdr->next);
+        fuse_blocks(h, hdr, hdr->next);
     }
-    while (previous_hdr_is_valid(hdr)) {
+    while (previous_hdr_is_valid(h, hdr)) {
         if (hdr->previous->free == false) {
             break;
         }
-        fuse_blocks(hdr, hdr->previous);
+        memory_header *previous = hdr->previous;
+        fuse_blocks(h, previous, hdr);
+        hdr = previous;
     }
 }
 
 /**
  * Find a free slot in memory for malloc()
  *
+ * @param h Is the heap we're working with.
  * @param size Is the amount of bytes we want to allocate, including sizeof memory header.
  * @return Pointer to header of a suitable block on success or NULL on error.
  */
-static memory_header *get_free_block(uint64_t size) {
-    memory_header *hdr = heap->start;
+static memory_header *get_free_block(heap_start *h, uint64_t size) {
+    memory_header *hdr = h->start;
 
     while ((hdr->free == false) || (hdr->size < size)) {
-        if (next_hdr_is_valid(hdr) == false) {
+        if (next_hdr_is_valid(h, hdr) == false) {
             return NULL;
         }
         hdr = hdr->next;
@@ -191,30 +236,35 @@ static memory_header *get_free_block(uint64_t size) {
  * @return true if it makes sense to split the block.
  */
 static bool space_for_new_blk(memory_header *hdr, uint64_t size) {
-    return (hdr->size - size - sizeof(memory_header)) > (2 * sizeof(memory_header));
+    return hdr->size > (size + (3 * sizeof(memory_header)));
 }
 
 /**
  * Helper to add a new memory block between the one we're allocating and the following one.
  *
+ * @param h Is the heap we're working with.
  * @param hdr Is a pointer to the memory header we're working with.
  * @param size Is the amount of bytes we want to allocate, including sizeof memory header.
  */
-static void insert_new_block(memory_header *hdr, uint64_t size) {
+static void insert_new_block(heap_start *h, memory_header *hdr, uint64_t size) {
     memory_header *next = (memory_header *)(((uint64_t)hdr) + size);
 
     next->free = true;
+    next->cached = false;
     next->size = (hdr->size - size);
     next->previous = hdr;
     next->next = hdr->next;
 
-    if (next->next->free) {
-        next->size += next->next->size;
-        next->next  = next->next->next; // :D
-        memset(next->next, 0, sizeof(memory_header));
+    if (next_hdr_is_valid(h, next) && next->next->free) {
+        memory_header *fused = next->next;
+        next->size += fused->size;
+        next->next  = fused->next; // :D
+        memset(fused, 0, sizeof(memory_header));
     }
 
-    next->next->previous = next;
+    if (next_hdr_is_valid(h, next)) {
+        next->next->previous = next;
+    }
 
     hdr->size = size;
     hdr->next = next;
@@ -223,73 +273,274 @@ static void insert_new_block(memory_header *hdr, uint64_t size) {
 /**
  * Helper to allocate a block and to adjust the heap accordingly
  *
+ * @param h Is the heap we're working with.
  * @param hdr Is a pointer to the memory header we're working with.
  * @param size Is the amount of bytes we want to allocate, including sizeof memory header.
  */
-static void allocate_block(memory_header *hdr, uint64_t size) {
+static void allocate_block(heap_start *h, memory_header *hdr, uint64_t size) {
     hdr->free = false;
-    if (next_hdr_is_valid(hdr)) {
-        if (space_for_new_blk(hdr, size)) {
-            insert_new_block(hdr, size);
-        }
-    } else {
-        if (hdr->next == NULL) {
-            insert_new_block(hdr, size);
-        }
+    if (space_for_new_blk(hdr, size)) {
+        insert_new_block(h, hdr, size);
     }
 }
 
 /**
  * Helper to free/delete a previously used memory block.
  *
+ * @param h Is the heap we're working with.
  * @param hdr Is a pointer to memory header structure we want to release.
  */
-static void __attribute__((always_inline)) delete_block(memory_header *hdr) {
+static void __attribute__((always_inline)) delete_block(heap_start *h, memory_header *hdr) {
     hdr->free = true;
-    fuse_walkthrough(hdr);
+    hdr->cached = false;
+    fuse_walkthrough(h, hdr);
 }
 
 /**
- * Helper to resize existing and allocated memory block.
- * The content of associated allocated memory is copied if the
- * block needs to be relocated.
+ * Allocate several blocks of same size from given heap or arena, 
+ * taking its lock just once.
  *
- * @param hdr Is a pointer to memory header structure for the block we're working with.
- * @param size Is the target size we want to match.
- * @return Pointer to memory header for resized block on success or NULL on error.
+ * @param h Is the heap to allocate from.
+ * @param size Is the amount of bytes to allocate, including sizeof memory header.
+ * @param ptrs Is where to store pointers to allocated memory.
+ * @param n Is the amount of blocks we want.
+ * @return Amount of blocks we got, less than n if heap ran out.
  */
-static memory_header *resize_block(memory_header *hdr, uint64_t size) {
-    memory_header *ret = hdr;
-    if (size <= hdr->size) {
-        if (space_for_new_blk(hdr, size)) {
-            insert_new_block(hdr, size);
+static uint32_t heap_alloc_batch(heap_start *h, uint64_t size, void **ptrs, uint32_t n) {
+    uint32_t got = 0;
+    bool int_enabled = spin_lock_irqsave(&h->lock);
+    while (got < n) {
+        memory_header *hdr = get_free_block(h, size);
+        if (!hdr) {
+            break;
         }
-    } else {
-        ret = get_free_block(size);
-        if (ret) {
-            void *s = ptr_for_header(hdr);
-            void *d = ptr_for_header(ret);
-            memcpy(s, d, (size - sizeof(memory_header)));
-            delete_block(hdr);
+        allocate_block(h, hdr, size);
+        ptrs[got++] = ptr_for_header(hdr);
+    }
+    spin_unlock_irqrestore(&h->lock, int_enabled);
+    return got;
+}
+
+/**
+ * Allocate memory from given heap or arena.
+ *
+ * @param h Is the heap to allocate from.
+ * @param size Is the amount of bytes to allocate, including sizeof memory header.
+ * @return Pointer to allocated memory on success or NULL on error.
+ */
+static void *heap_alloc(heap_start *h, uint64_t size) {
+    void *ret = NULL;
+    (void)heap_alloc_batch(h, size, &ret, 1);
+    return ret;
+}
+
+/**
+ * Return several blocks to whichever heap or arena owns them. Lock 
+ * of owner is kept for as long as consecutive blocks share it.
+ *
+ * @param ptrs Is pointers to previously allocated memory.
+ * @param n Is the amount of pointers.
+ */
+static void heap_free_batch(void **ptrs, uint32_t n) {
+    heap_start *h = NULL;
+    bool int_enabled = interrupts_enabled();
+    cli();
+    for (uint32_t i = 0; i < n; i++) {
+        heap_start *owner = heap_for_ptr(ptrs[i]);
+        if (owner != h) {
+            if (h) {
+                spin_unlock(&h->lock);
+            }
+            h = owner;
+            spin_lock(&h->lock);
         }
+        memory_header *hdr = header_for_ptr(ptrs[i]);
+        if (hdr->free) {
+            spin_unlock(&h->lock);
+            panic("Double free for %p\n", ptrs[i]);
+        }
+        delete_block(h, hdr);
+    }
+    if (h) {
+        spin_unlock(&h->lock);
+    }
+    if (int_enabled) {
+        sti();
+    }
+}
+
+/**
+ * Get size class of per-cpu caches an allocation fits in.
+ *
+ * @param size Is the requested size to allocate
+ * @return Size class, HEAP_CACHE_CLASSES if it's too big to cache.
+ */
+static uint32_t heap_cache_class(uint64_t size) {
+    uint32_t class = 0;
+    while ((class < HEAP_CACHE_CLASSES) && (size > ((uint64_t)HEAP_CACHE_MIN << class))) {
+        class++;
+    }
+    return class;
+}
+
+/**
+ * Get size class of an allocated block. Only blocks of exactly class
+ * size can go to caches, blocks heap didn't split are a bit bigger.
+ *
+ * @param hdr Is a pointer to the memory header we're working with.
+ * @return Size class, HEAP_CACHE_CLASSES if block isn't of any.
+ */
+static uint32_t heap_cache_class_of(memory_header *hdr) {
+    for (uint32_t class = 0; class < HEAP_CACHE_CLASSES; class++) {
+        if (hdr->size == aligned_size((uint64_t)HEAP_CACHE_MIN << class)) {
+            return class;
+        }
+    }
+    return HEAP_CACHE_CLASSES;
+}
+
+/**
+ * Take a block of given size class from cache of the cpu we're on,
+ * refilling the cache with a batch from our arena or main heap if
+ * it's empty. Interrupts are kept off, handlers may allocate too.
+ *
+ * @param class Is the size class.
+ * @return Pointer to allocated memory on success or NULL on error.
+ */
+static void *heap_cache_get(uint32_t class) {
+    void *ret = NULL;
+    bool int_enabled = interrupts_enabled();
+    cli();
+    percpu_data *cpu = this_cpu();
+    heap_cache *cache = &cpu->cache[class];
+    if (cache->count == 0) {
+        uint64_t size = aligned_size((uint64_t)HEAP_CACHE_MIN << class);
+        if (cpu->heap) {
+            cache->count = heap_alloc_batch(cpu->heap, size, cache->slot, HEAP_CACHE_BATCH);
+        }
+        if (cache->count < HEAP_CACHE_BATCH) {
+            cache->count += heap_alloc_batch(heap, size, &cache->slot[cache->count], 
+                    (HEAP_CACHE_BATCH - cache->count));
+        }
+        for (uint32_t i = 0; i < cache->count; i++) {
+            header_for_ptr(cache->slot[i])->cached = true;
+        }
+    }
+    if (cache->count) {
+        ret = cache->slot[--cache->count];
+        header_for_ptr(ret)->cached = false;
+    }
+    if (int_enabled) {
+        sti();
     }
     return ret;
 }
 
 /**
- * Allocate memory from heap for the calling function.
+ * Put a block of given size class to cache of the cpu we're on, 
+ * draining a batch back to heap first if the cache is full.
+ *
+ * @param class Is the size class.
+ * @param ptr Is a pointer to previously allocated memory.
+ */
+static void heap_cache_put(uint32_t class, void *ptr) {
+    bool int_enabled = interrupts_enabled();
+    cli();
+    heap_cache *cache = &this_cpu()->cache[class];
+    if (cache->count == HEAP_CACHE_SLOTS) {
+        cache->count -= HEAP_CACHE_BATCH;
+        heap_free_batch(&cache->slot[cache->count], HEAP_CACHE_BATCH);
+    }
+    header_for_ptr(ptr)->cached = true;
+    cache->slot[cache->count++] = ptr;
+    if (int_enabled) {
+        sti();
+    }
+}
+
+/**
+ * Return everything in caches of the cpu we're on to heap. Done when
+ * heap runs out and by cpus going to sleep.
+ */
+void heap_cache_drain(void) {
+    bool int_enabled = interrupts_enabled();
+    cli();
+    percpu_data *cpu = this_cpu();
+    for (uint32_t class = 0; class < HEAP_CACHE_CLASSES; class++) {
+        heap_free_batch(cpu->cache[class].slot, cpu->cache[class].count);
+        cpu->cache[class].count = 0;
+    }
+    if (int_enabled) {
+        sti();
+    }
+}
+
+/**
+ * Carve an arena out of main heap. Cpus given an arena allocate from
+ * it first, under its own lock, and fall back to main heap when it's
+ * full.
+ *
+ * @param size Is the amount of bytes the arena takes from main heap.
+ * @return Pointer to arena on success or NULL on error.
+ */
+heap_start *heap_arena_create(uint64_t size) {
+    if ((heap_arena_count == HEAP_MAX_ARENAS) || 
+        (size < (sizeof(heap_start) + (4 * sizeof(memory_header))))) {
+        return NULL;
+    }
+    heap_start *arena = malloc(size);
+    if (!arena) {
+        return NULL;
+    }
+    memory_header *first = (memory_header *)((uint64_t)arena + aligned_size(sizeof(heap_start)));
+    heap_setup(arena, first, (size - ((uint64_t)first - (uint64_t)arena)));
+
+    bool int_enabled = spin_lock_irqsave(&heap->lock);
+    bool full = (heap_arena_count == HEAP_MAX_ARENAS);
+    if (!full) {
+        heap_arenas[heap_arena_count] = arena;
+        __atomic_store_n(&heap_arena_count, (heap_arena_count + 1), __ATOMIC_RELEASE);
+    }
+    spin_unlock_irqrestore(&heap->lock, int_enabled);
+    if (full) {
+        free(arena);
+        return NULL;
+    }
+    return arena;
+}
+
+/**
+ * Allocate memory from heap for the calling function. Small sizes 
+ * come from per-cpu caches, others from arena of the cpu we're on 
+ * and then main heap.
  *
  * @param size Is the amount of bytes to allocate.
  * @return Pointer to allocated memory on success or NULL on error.
  */
 void *malloc(uint64_t size) {
+    uint32_t class = heap_cache_class(size);
+    if (heap_cache_enabled && (class < HEAP_CACHE_CLASSES)) {
+        void *ret = heap_cache_get(class);
+        if (ret) {
+            return ret;
+        }
+        // Keep class size, so that the block can be cached once freed
+        size = ((uint64_t)HEAP_CACHE_MIN << class);
+    }
     size = aligned_size(size);
-    memory_header *hdr = get_free_block(size);
-    if (!hdr) {
-        return NULL;
+    heap_start *arena = this_cpu()->heap;
+    if (arena) {
+        void *ret = heap_alloc(arena, size);
+        if (ret) {
+            return ret;
+        }
+    }
+    void *ret = heap_alloc(heap, size);
+    if (!ret) {
+        // Our caches may hold just what we need
+        heap_cache_drain();
+        ret = heap_alloc(heap, size);
     }
-    allocate_block(hdr, size);
-    void *ret = ptr_for_header(hdr);
     return ret;
 }
 
@@ -319,17 +570,30 @@ void *calloc(uint64_t nmemb, uint64_t size) {
  *
  */
 void *realloc(void *ptr, uint64_t size) {
-    memory_header *hdr = header_for_ptr(ptr);
-    memory_header *got = resize_block(hdr, (size + sizeof(memory_header)));
-    if (!got) {
-        return NULL;
+    if (!ptr) {
+        return malloc(size);
     }
-    if (hdr == got) {
+    memory_header *hdr = header_for_ptr(ptr);
+    heap_start *h = heap_for_ptr(ptr);
+    uint64_t want = aligned_size(size);
+
+    bool int_enabled = spin_lock_irqsave(&h->lock);
+    uint64_t have = hdr->size;
+    if (want <= have) {
+        if (space_for_new_blk(hdr, want)) {
+            insert_new_block(h, hdr, want);
+        }
+        spin_unlock_irqrestore(&h->lock, int_enabled);
         return ptr;
     }
-    void *dst = ptr_for_header(got);
-    memcpy(ptr, dst, size);
-    delete_block(hdr);
+    spin_unlock_irqrestore(&h->lock, int_enabled);
+
+    void *dst = malloc(size);
+    if (!dst) {
+        return NULL;
+    }
+    memcpy(ptr, dst, (have - sizeof(memory_header)));
+    free(ptr);
     return dst;
 }
 
@@ -340,9 +604,13 @@ void *realloc(void *ptr, uint64_t size) {
  */
 void free(void *ptr) {
     memory_header *hdr = header_for_ptr(ptr);
-    if (hdr->free) {
+    if (hdr->free || hdr->cached) {
         panic("Double free for %p\n", ptr);
     }
-    delete_block(hdr);
+    uint32_t class = heap_cache_class_of(hdr);
+    if (heap_cache_enabled && (class < HEAP_CACHE_CLASSES)) {
+        heap_cache_put(class, ptr);
+        return;
+    }
+    heap_free_batch(&ptr, 1);
 }
-
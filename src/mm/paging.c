@@ -66,7 +66,7 @@ static void map_page(page_table_entry *entry, void *addr) {
 
 bool map_address(void *addr, uint64_t size) {
     if (size & 0x00000FFF) {
-        blogf("refusing to map unaligned memory: 0x%x bytes\n", size);
+        blogf("refusing to map unaligned memory: 0x%lx bytes\n", size);
         return false;
     }
     uint64_t vaddr = (uint64_t)addr;
@@ -35,35 +35,62 @@
 #include <stdlib.h>
 
 #include <panic.h>
+#include <init_graph.h>
 
 #include <sys/io.h>
+#include <sys/malloc_bench.h>
+#include <sys/profile.h>
 
 #include <cpu/common.h>
+#include <cpu/smp.h>
 #include <superio/superio.h>
 
 #include <drivers/device.h>
 #include <drivers/serial/serial.h>
+#include <drivers/debugcon/debugcon.h>
+#include <drivers/fbcon/fbcon.h>
+#include <drivers/vgatext/vgatext.h>
 #include <drivers/kbdctl/8042.h>
 #include <drivers/pic_8259/pic.h>
 #include <drivers/pit/pit.h>
+#include <drivers/lapic/lapic.h>
 #include <drivers/pci/pci.h>
 #include <drivers/cmos/cmos.h>
 #include <drivers/ata/ata.h>
 
 #include <mainboards/memory_init.h>
+#include <mainboards/config.h>
 
 #include <mm/paging.h>
 
 #include <console/console.h>
+#include <console/memring.h>
 #include <interrupts/interrupts.h>
 
+#include <time/clock.h>
+#include <time/timestamp.h>
+#include <time/tick.h>
+#include <time/timer.h>
+
+// Binary log records may hold 0x0A anywhere, uart mustn't turn it
+// into CRLF then
+#ifdef CONFIG_BINARY_LOG
+#define UART_CONSOLE_WRITE serial_console_write_raw
+#else
+#define UART_CONSOLE_WRITE serial_console_write
+#endif
+
 extern device *memory_device;
 extern device *cmos_dev;
 extern device *uart_dev;
-extern console_device default_console_device;
+extern device *debugcon_dev;
+extern device *memring_dev;
+extern device *fbcon_dev;
+extern device *vgatext_dev;
 extern device *keyboard_controller_device;
 extern device *programmable_interrupt_controller;
 extern device *programmable_interrupt_timer;
+extern device *local_apic_dev;
 extern device **pci_device_array;
 extern ata_ide **ata_ide_array;
 
@@ -90,46 +117,203 @@ enum DEVICE_STATUS init_memory_map(device *dev) {
 
     bool stat = mainboard_specific_memory_init(dev);
     if (!stat) {
-        blog("Mainboard-specific memory init failed, fallback to CMOS\n");
+        blog_warning("Mainboard-specific memory init failed, fallback to CMOS\n");
         cmos_read_memory_info(map);
         ret = status_faulty;
     }
-    blog("Memory map:\n");
-    for (int i = 0; i < map->count; i++) {
-        blogf(" + 0x%08x - 0x%08x: %s\n", map->entry[i]->addr, map->entry[i]->size, ram_type_to_str(map->entry[i]->type));
+    memring_reserve(map);
+    timestamp_reserve(map);
+    smp_reserve(map);
+    if (blog_enabled(log_debug)) {
+        blog_debug("Memory map:\n");
+        for (int i = 0; i < map->count; i++) {
+            blogf_debug(" + 0x%08lx - 0x%08lx: %s\n", map->entry[i]->addr, map->entry[i]->size, 
+                    ram_type_to_str(map->entry[i]->type));
+        }
     }
     return ret;
 }
 
-/* Initialize a output device, and make it our default
- * output device for blogf, panic, etc.
+/* Initialize a output device, and add it to console sinks
+ * for blogf, panic, etc.
  *
- * @param device *dev                    -- Target device structure
- * @param device_init_function init_func -- Init function to use for the device
- * @param tx_func write_func             -- Function to use for writing output to this device
- * @param char *name                     -- Name of our output device
- * @param 
- * @return bool true if switch succeeded
+ * @param device *dev                        -- Target device structure
+ * @param device_init_function init_func     -- Init function to use for the device
+ * @param console_write_func write_func      -- Function to use for writing output to this device
+ * @param char *name                         -- Name of our output device
+ * @param enum LOG_LEVEL level               -- Most verbose messages to send to this device
+ * @param uint8_t flags                      -- CONSOLE_SINK_* flags
+ * @return bool true if device was added
  */
-bool switch_output_device(device *dev, device_init_function init_func, tx_func write_func, char *name) {
+bool attach_output_device(device *dev, device_init_function init_func, 
+        console_write_func write_func, char *name, enum LOG_LEVEL level, uint8_t flags) {
     if (dev->status != status_initialised) {
         dev->status = init_func(dev);
         dev->device_name = name;
         if (dev->status != status_initialised) {
-            blogf("Failed to switch to output device %s\n", name);
+            blogf("Failed to attach output device %s\n", name);
+            return false;
         }
     }
-    default_console_device.enabled = true;
-    default_console_device.dev = dev;
-    default_console_device.tx_func = write_func;
-    blogf("Switched default output device to %s\n", dev->device_name);
+    if (console_add_sink(dev, write_func, name, level, flags) == NULL) {
+        blogf("Out of console sinks for %s\n", name);
+        return false;
+    }
+    blogf("Attached output device %s\n", dev->device_name);
     return true;
 }
 
+// PCI devices found, for steps after PCI enumeration
+static uint8_t pci_device_count = 0;
+
+static void post_step_pic(void) {
+    initialize_device(pic_initialize, programmable_interrupt_controller, "8259/PIC", false);
+    if (serial_enable_irq(uart_dev)) {
+        sti();
+    }
+}
+
+static void post_step_pit(void) {
+    initialize_device(pit_init, programmable_interrupt_timer, "825X/PIT", false);
+}
+
+static void post_step_timer(void) {
+    if (timer_init()) {
+        console_start_flush_timer();
+        profile_init();
+    }
+}
+
+static void post_step_pci(void) {
+    pci_device_array = calloc(32, sizeof(device **));
+    timestamp(ts_pci_start, "PCI enumeration");
+    pci_device_count = enumerate_pci_buses(pci_device_array);
+    timestamp(ts_pci_end, "PCI enumeration");
+    pci_print_devtree(pci_device_array, pci_device_count);
+}
+
+static void post_step_clocksource(void) {
+    clocksource_init(pci_device_array, pci_device_count);
+}
+
+static void post_step_lapic(void) {
+    local_apic_dev = new_device(sizeof(lapic_device));
+    initialize_device(lapic_init, local_apic_dev, "LAPIC", false);
+}
+
+static void post_step_smp(void) {
+    smp_init();
+    malloc_bench();
+}
+
+// Timer interrupts go one-shot from here on, programmed for whichever
+// timer is due next.
+static void post_step_tick(void) {
+    tick_init();
+}
+
+static void post_step_kbdctl(void) {
+    initialize_device(kbdctl_set_default_init, keyboard_controller_device, "8042/PS2", false);
+}
+
+static void post_step_cmos(void) {
+    initialize_device(cmos_init, cmos_dev, "CMOS/RTC", false);
+}
+
+static void post_step_ata(void) {
+    ata_ide_array = calloc(1, sizeof(ata_ide **));
+    timestamp(ts_ata_start, "ATA probe");
+    uint8_t ide_cnt = init_ata_controllers(pci_device_array, ata_ide_array, pci_device_count);
+    timestamp(ts_ata_end, "ATA probe");
+    blogf_debug("%d IDE controller(s) initialised\n", ide_cnt);
+}
+
+static void post_step_fbcon(void) {
+    fbcon_dev = new_device(sizeof(fbcon_console));
+    if (mainboard_framebuffer(pci_device_array, pci_device_count, 
+                &((fbcon_console *)fbcon_dev->device_data)->fb)) {
+        // Text buffer is gone once display is in graphics mode
+        if (attach_output_device(fbcon_dev, fbcon_init, fbcon_console_write, "fbcon", log_info,
+                CONSOLE_SINK_BUFFERED)) {
+            console_detach_device(vgatext_dev);
+        }
+    }
+}
+
+enum POST_STEPS {
+    post_pic,
+    post_pit,
+    post_timer,
+    post_pci,
+    post_clocksource,
+    post_lapic,
+    post_smp,
+    post_tick,
+    post_kbdctl,
+    post_cmos,
+    post_ata,
+    post_fbcon,
+    post_step_count
+};
+
+/* Device bring-up and what each step needs done before it. Anything
+ * not ordered here runs concurrently, slow probes that poll hardware
+ * yield while they wait.
+ */
+static init_step post_steps[post_step_count] = {
+    [post_pic]          = { "PIC",          post_step_pic,          0 },
+    [post_pit]          = { "PIT",          post_step_pit,          INIT_DEP(post_pic) },
+    [post_timer]        = { "timer",        post_step_timer,        0 },
+    [post_pci]          = { "PCI",          post_step_pci,          0 },
+    // ACPI PM timer is found through PCI
+    [post_clocksource]  = { "clocksource",  post_step_clocksource,  INIT_DEP(post_pci) },
+    // Virtual wire mode routes PIC through LINT0
+    [post_lapic]        = { "LAPIC",        post_step_lapic,        INIT_DEP(post_pic) },
+    // INIT-SIPI-SIPI goes through local apic, delays yield
+    [post_smp]          = { "SMP",          post_step_smp,          INIT_DEP(post_lapic) },
+    [post_tick]         = { "tick",         post_step_tick,
+        (INIT_DEP(post_pit) | INIT_DEP(post_lapic) | INIT_DEP(post_timer) | INIT_DEP(post_clocksource)) },
+    [post_kbdctl]       = { "8042",         post_step_kbdctl,       0 },
+    [post_cmos]         = { "CMOS",         post_step_cmos,         0 },
+    // Buses are probed in parallel on APs
+    [post_ata]          = { "ATA",          post_step_ata,          (INIT_DEP(post_pci) | INIT_DEP(post_smp)) },
+    [post_fbcon]        = { "fbcon",        post_step_fbcon,        INIT_DEP(post_pci) },
+};
+
 void post_and_init(void) {
+    // Everything below that waits for hardware wants real time delays
+    bool tsc_known = clock_init();
+
+    // Persistent log goes first so that it sees everything, that's 
+    // just memcpy and doesn't need line buffering.
+    memring_dev = new_device(sizeof(console_memring));
+    memring_dev->device_name = "memring";
+    memring_dev->status = memring_init(memring_dev);
+    console_add_sink(memring_dev, memring_console_write, "memring", log_spew, 0);
+    blogf("*** TinyBIOS boot %d ***\n", ((console_memring *)memring_dev->device_data)->ring->boot_count);
+
     uart_dev = new_device(sizeof(serial_uart_device));
-    switch_output_device(uart_dev, serial_init_device, serial_tx, "UART 1");
+    attach_output_device(uart_dev, serial_init_device, UART_CONSOLE_WRITE, "UART 1", log_info,
+            (CONSOLE_SINK_BUFFERED | CONSOLE_SINK_BINARY));
+    uart_print_info(uart_dev);
+
+    // Under emulators debug console is a lot faster than emulated uart,
+    // so it can take everything.
+    debugcon_dev = new_device(sizeof(debugcon_device));
+    attach_output_device(debugcon_dev, debugcon_init, debugcon_console_write, "debugcon", log_spew,
+            (CONSOLE_SINK_BUFFERED | CONSOLE_SINK_BINARY));
 
+    // Legacy text mode screen, if someone has set one up for us
+    vgatext_dev = new_device(sizeof(vgatext_console));
+    attach_output_device(vgatext_dev, vgatext_init, vgatext_console_write, "vgatext", log_info,
+            CONSOLE_SINK_BUFFERED);
+
+    if (tsc_known) {
+        blogf("TSC running at %lu kHz (%s)\n", system_clock.tsc_khz,
+                clock_freq_source_name(system_clock.freq_source));
+    } else {
+        blogf_warning("TSC calibration failed, assuming %lu kHz\n", system_clock.tsc_khz);
+    }
 
     memory_device                     = new_device(sizeof(memory_map));
     programmable_interrupt_controller = new_device(sizeof(pic_full_configuration));
@@ -140,16 +324,15 @@ void post_and_init(void) {
     memory_device->status = init_memory_map(memory_device); 
     init_paging((memory_map *)memory_device->device_data);
 
-    initialize_device(pic_initialize, programmable_interrupt_controller, "8259/PIC", false);
-    initialize_device(kbdctl_set_default_init, keyboard_controller_device, "8042/PS2", false);
-    initialize_device(cmos_init, cmos_dev, "CMOS/RTC", false);
-    initialize_device(pit_init, programmable_interrupt_timer, "825X/PIT", false);
+    init_graph_run(post_steps, post_step_count);
 
-    pci_device_array = calloc(32, sizeof(device **));
-    uint8_t devcnt = enumerate_pci_buses(pci_device_array);
-    pci_print_devtree(pci_device_array, devcnt);
-    ata_ide_array = calloc(1, sizeof(ata_ide **));
-    uint8_t ide_cnt = init_ata_controllers(pci_device_array, ata_ide_array, devcnt);
+    timestamp(ts_post_done, "POST done");
+    timestamp_report();
+    io_account_report(IO_ACCOUNT_TOP_N);
+    profile_report();
+
+    serial_print_stats(uart_dev);
+    console_flush();
 
 } 
 
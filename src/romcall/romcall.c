@@ -81,7 +81,7 @@ void find_and_exec_roms(void) {
         if (rom_header_present(entry) == false) {
             continue;
         }
-        blogf("Found possible option rom entry at 0x%x\n", entry);
+        blogf_debug("Found possible option rom entry at 0x%lx\n", entry);
 
         void *shadow = copy_rom_to_ram(entry);
         if (!shadow) {
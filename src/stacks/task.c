@@ -0,0 +1,201 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2026, k4m1 <me@k4m1.net>
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+ 
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+ 
+ 3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <console/console.h>
+#include <cpu/common.h>
+#include <cpu/percpu.h>
+#include <panic.h>
+
+#include <stacks/task.h>
+#include <time/clock.h>
+
+// Boot flow, runs on whatever stack we had to begin with
+static task main_task = {
+    .next = &main_task,
+    .name = "main"
+};
+
+static task *current = &main_task;
+static uint32_t tasks_running = 0;
+
+// Task that has exited, can't free its stack while still on it so 
+// whoever runs next does it
+static task *task_zombie = NULL;
+
+/* Save callee saved registers on current stack, switch to another 
+ * stack and pop the same from there. System V ABI leaves everything
+ * else to the caller, so this is all there is to it. Interrupt flag
+ * is left alone, whoever does sti does it for everyone.
+ *
+ * @param uint64_t *save_rsp -- where to save current stack pointer
+ * @param uint64_t load_rsp  -- stack pointer to switch to
+ */
+static void __attribute__((naked, noinline)) task_switch(uint64_t *save_rsp 
+        __attribute__((unused)), uint64_t load_rsp __attribute__((unused))) {
+    asm volatile(
+        "push   rbp;"
+        "push   rbx;"
+        "push   r12;"
+        "push   r13;"
+        "push   r14;"
+        "push   r15;"
+        "mov    [rdi], rsp;"
+        "mov    rsp, rsi;"
+        "pop    r15;"
+        "pop    r14;"
+        "pop    r13;"
+        "pop    r12;"
+        "pop    rbx;"
+        "pop    rbp;"
+        "ret;"
+    );
+}
+
+/* Free stack of task that exited, if any
+ */
+static void task_reap(void) {
+    if (task_zombie) {
+        free(task_zombie->stack);
+        free(task_zombie);
+        task_zombie = NULL;
+    }
+}
+
+/* Take current task off run ring and switch to next one, never 
+ * returns.
+ */
+static void __attribute__((noreturn)) task_exit(void) {
+    task *self = current;
+    task *prev = self;
+    while (prev->next != self) {
+        prev = prev->next;
+    }
+    prev->next = self->next;
+    tasks_running--;
+    blogf_debug("task %s done in %lu us\n", self->name, 
+            ((now_ns() - self->started_ns) / 1000));
+
+    task_zombie = self;
+    current = self->next;
+    task_switch(&self->rsp, current->rsp);
+    __builtin_unreachable();
+}
+
+/* First thing new task runs, task_switch() returns here
+ */
+static void __attribute__((noreturn)) task_start(void) {
+    task_reap();
+    current->entry(current->arg);
+    task_exit();
+}
+
+/* Start a new task, it gets to run on next yield(). Task is freed 
+ * once entry returns.
+ *
+ * @param char *name        -- name for logging
+ * @param task_entry entry  -- function to run
+ * @param void *arg         -- argument for entry
+ * @return bool true if task was created, false if we're out of memory
+ */
+bool task_spawn(char *name, task_entry entry, void *arg) {
+    task *t = calloc(1, sizeof(task));
+    if (t == NULL) {
+        return false;
+    }
+    t->stack = malloc(TASK_STACK_SIZE);
+    if (t->stack == NULL) {
+        free(t);
+        return false;
+    }
+    t->entry = entry;
+    t->arg = arg;
+    t->name = name;
+    t->started_ns = now_ns();
+
+    // Build stack to look like task_switch() had saved it, returning
+    // to task_start() with stack aligned like after a call.
+    uint64_t *sp = (uint64_t *)(((uint64_t)t->stack + TASK_STACK_SIZE) & ~0x0FULL);
+    *--sp = 0;
+    *--sp = (uint64_t)task_start;
+    for (int reg = 0; reg < 6; reg++) {
+        *--sp = 0;
+    }
+    t->rsp = (uint64_t)sp;
+
+    // Run after everyone else that's already queued
+    task *prev = current;
+    while (prev->next != current) {
+        prev = prev->next;
+    }
+    t->next = current;
+    prev->next = t;
+    tasks_running++;
+    return true;
+}
+
+/* Let other tasks run, returns once everyone else has had their turn.
+ * Only to be called from task context, not from interrupt handlers.
+ * Tasks are boot cpu only, work running on APs just gets a pause.
+ */
+void yield(void) {
+    task *self = current;
+    if ((this_cpu()->index != 0) || (self->next == self)) {
+        cpu_relax();
+        return;
+    }
+    current = self->next;
+    task_switch(&self->rsp, current->rsp);
+    task_reap();
+}
+
+/* Yield until all spawned tasks are done. Only main task may join.
+ */
+void task_join_all(void) {
+    if (current != &main_task) {
+        panic("task_join_all() called from task\n");
+    }
+    while (tasks_running) {
+        yield();
+    }
+}
+
+/* Get amount of tasks running besides main task
+ *
+ * @return uint32_t tasks
+ */
+uint32_t task_count(void) {
+    return tasks_running;
+}
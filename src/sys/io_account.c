@@ -0,0 +1,264 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2026, k4m1 <me@k4m1.net>
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+ 
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+ 
+ 3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <sys/io.h>
+
+#include <console/console.h>
+#include <time/clock.h>
+
+// Unknown ports are counted per 8 port block, in as many slots as we
+// have, rest go to "other"
+#define IO_ACCOUNT_BLOCK_MASK   0xFFF8
+#define IO_ACCOUNT_BLOCK_SLOTS  16
+
+/* Port i/o done by one subsystem
+ *
+ * @member char *name        -- subsystem
+ * @member uint64_t reads    -- accesses reading from port
+ * @member uint64_t writes   -- accesses writing to port
+ * @member uint64_t cycles   -- TSC cycles spent, exits included
+ */
+typedef struct {
+    char *name;
+    uint64_t reads;
+    uint64_t writes;
+    uint64_t cycles;
+} io_account_entry;
+
+/* Port range that belongs to a subsystem
+ *
+ * @member unsigned short first -- first port
+ * @member unsigned short last  -- last port, inclusive
+ * @member uint8_t subsystem    -- index to io_subsystems
+ */
+typedef struct {
+    unsigned short first;
+    unsigned short last;
+    uint8_t subsystem;
+} io_account_range;
+
+enum IO_SUBSYSTEMS {
+    io_pic,
+    io_pit,
+    io_kbdctl,
+    io_cmos,
+    io_post,
+    io_superio,
+    io_ata_primary,
+    io_ata_secondary,
+    io_uart,
+    io_vga,
+    io_bochs_vbe,
+    io_fwcfg,
+    io_debugcon,
+    io_pci_config,
+    io_acpi_pm,
+    io_other,
+    io_subsystem_count
+};
+
+static io_account_entry io_subsystems[io_subsystem_count] = {
+    [io_pic]            = { .name = "PIC" },
+    [io_pit]            = { .name = "PIT" },
+    [io_kbdctl]         = { .name = "8042" },
+    [io_cmos]           = { .name = "CMOS" },
+    [io_post]           = { .name = "POST 0x80" },
+    [io_superio]        = { .name = "superio" },
+    [io_ata_primary]    = { .name = "ATA 0" },
+    [io_ata_secondary]  = { .name = "ATA 1" },
+    [io_uart]           = { .name = "UART" },
+    [io_vga]            = { .name = "VGA" },
+    [io_bochs_vbe]      = { .name = "bochs VBE" },
+    [io_fwcfg]          = { .name = "fw_cfg" },
+    [io_debugcon]       = { .name = "debugcon" },
+    [io_pci_config]     = { .name = "PCI CF8/CFC" },
+    [io_acpi_pm]        = { .name = "ACPI PM" },
+    [io_other]          = { .name = "other" },
+};
+
+// Legacy ports, and where qemu puts the rest
+static const io_account_range io_ranges[] = {
+    { 0x0020, 0x0021, io_pic },
+    { 0x00A0, 0x00A1, io_pic },
+    { 0x0040, 0x0043, io_pit },
+    { 0x0061, 0x0061, io_pit },
+    { 0x0060, 0x0060, io_kbdctl },
+    { 0x0064, 0x0064, io_kbdctl },
+    { 0x0070, 0x0071, io_cmos },
+    { 0x0080, 0x0080, io_post },
+    { 0x002E, 0x002F, io_superio },
+    { 0x004E, 0x004F, io_superio },
+    { 0x01F0, 0x01F7, io_ata_primary },
+    { 0x03F6, 0x03F6, io_ata_primary },
+    { 0x0170, 0x0177, io_ata_secondary },
+    { 0x0376, 0x0376, io_ata_secondary },
+    { 0x03F8, 0x03FF, io_uart },
+    { 0x02F8, 0x02FF, io_uart },
+    { 0x03E8, 0x03EF, io_uart },
+    { 0x02E8, 0x02EF, io_uart },
+    { 0x03B0, 0x03DF, io_vga },
+    { 0x01CE, 0x01CF, io_bochs_vbe },
+    { 0x0510, 0x051B, io_fwcfg },
+    { 0x00E9, 0x00E9, io_debugcon },
+    { 0x0CF8, 0x0CFF, io_pci_config },
+    { 0xB000, 0xB03F, io_acpi_pm },
+};
+
+// Ports we had no range for, such as PCI BARs
+static io_account_entry io_blocks[IO_ACCOUNT_BLOCK_SLOTS];
+static unsigned short io_block_port[IO_ACCOUNT_BLOCK_SLOTS];
+static char io_block_name[IO_ACCOUNT_BLOCK_SLOTS][8];
+static uint8_t io_block_count = 0;
+
+/* Find counters for 8 port block of unknown port, taking a new slot
+ * if there's one left
+ *
+ * @param unsigned short port -- port accessed
+ * @return io_account_entry * to count in
+ */
+static io_account_entry __attribute__((no_caller_saved_registers)) *io_account_block(unsigned short port) {
+    unsigned short block = (port & IO_ACCOUNT_BLOCK_MASK);
+    for (uint8_t i = 0; i < io_block_count; i++) {
+        if (io_block_port[i] == block) {
+            return &io_blocks[i];
+        }
+    }
+    if (io_block_count == IO_ACCOUNT_BLOCK_SLOTS) {
+        return &io_subsystems[io_other];
+    }
+    uint8_t slot = io_block_count;
+    const char *hex = "0123456789abcdef";
+    char *name = io_block_name[slot];
+    name[0] = 'p';
+    name[1] = hex[(block >> 12) & 0x0F];
+    name[2] = hex[(block >> 8) & 0x0F];
+    name[3] = hex[(block >> 4) & 0x0F];
+    name[4] = hex[block & 0x0F];
+    name[5] = '+';
+    name[6] = '8';
+    name[7] = 0;
+    io_block_port[slot] = block;
+    io_blocks[slot].name = name;
+    io_block_count++;
+    return &io_blocks[slot];
+}
+
+/* Record port access, called from {in,out}{b,w,l} right after the 
+ * access itself. Interrupt handlers do port i/o too, and we don't 
+ * disable interrupts here, so counts are approximate.
+ *
+ * @param unsigned short port    -- port accessed
+ * @param enum IO_ACCOUNT_DIR dir -- read or write
+ * @param uint64_t count         -- amount of accesses, >1 for string i/o
+ * @param uint64_t start         -- TSC before access
+ */
+void __attribute__((no_caller_saved_registers)) io_account(unsigned short port, 
+        enum IO_ACCOUNT_DIR dir, uint64_t count, uint64_t start) {
+    uint64_t cycles = (io_account_tsc() - start);
+    io_account_entry *ent = NULL;
+    for (size_t i = 0; i < (sizeof(io_ranges) / sizeof(io_ranges[0])); i++) {
+        if ((port >= io_ranges[i].first) && (port <= io_ranges[i].last)) {
+            ent = &io_subsystems[io_ranges[i].subsystem];
+            break;
+        }
+    }
+    if (ent == NULL) {
+        ent = io_account_block(port);
+    }
+    if (dir == io_account_read) {
+        ent->reads += count;
+    } else {
+        ent->writes += count;
+    }
+    ent->cycles += cycles;
+}
+
+/* Print subsystems that did most port i/o, by cycles spent. Console
+ * output itself does port i/o, so totals are taken before printing.
+ *
+ * @param unsigned int top_n -- how many to list
+ */
+void io_account_report(unsigned int top_n) {
+    io_account_entry *all[io_subsystem_count + IO_ACCOUNT_BLOCK_SLOTS];
+    io_account_entry snap[io_subsystem_count + IO_ACCOUNT_BLOCK_SLOTS];
+    size_t count = 0;
+    uint64_t total_cycles = 0;
+    uint64_t total_access = 0;
+
+    for (size_t i = 0; i < io_subsystem_count; i++) {
+        snap[count] = io_subsystems[i];
+        all[count] = &snap[count];
+        count++;
+    }
+    for (size_t i = 0; i < io_block_count; i++) {
+        snap[count] = io_blocks[i];
+        all[count] = &snap[count];
+        count++;
+    }
+    for (size_t i = 0; i < count; i++) {
+        total_cycles += all[i]->cycles;
+        total_access += (all[i]->reads + all[i]->writes);
+    }
+    if (total_access == 0) {
+        return;
+    }
+
+    // Selection sort, there's only a few dozen of them
+    if (top_n > count) {
+        top_n = count;
+    }
+    for (size_t i = 0; i < top_n; i++) {
+        for (size_t j = (i + 1); j < count; j++) {
+            if (all[j]->cycles > all[i]->cycles) {
+                io_account_entry *tmp = all[i];
+                all[i] = all[j];
+                all[j] = tmp;
+            }
+        }
+    }
+
+    blogf("Port i/o: %lu accesses, %lu us. Top %d by time:\n", total_access,
+            (clock_ticks_to_ns(total_cycles) / 1000), top_n);
+    blogf("  %-12s %10s %10s %10s %6s\n", "subsystem", "reads", "writes", "us", "share");
+    for (size_t i = 0; i < top_n; i++) {
+        io_account_entry *ent = all[i];
+        if ((ent->reads + ent->writes) == 0) {
+            break;
+        }
+        uint64_t permille = ((ent->cycles * 1000) / (total_cycles ? total_cycles : 1));
+        blogf("  %-12s %10lu %10lu %10lu %3lu.%lu%%\n", ent->name, ent->reads, ent->writes,
+                (clock_ticks_to_ns(ent->cycles) / 1000), (permille / 10), (permille % 10));
+    }
+}
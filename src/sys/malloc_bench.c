@@ -0,0 +1,136 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2026, k4m1 <me@k4m1.net>
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+ 
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+ 
+ 3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <console/console.h>
+#include <cpu/common.h>
+#include <cpu/smp.h>
+
+#include <sys/atomic.h>
+#include <sys/malloc_bench.h>
+
+#include <time/clock.h>
+
+/* One benchmark run
+ *
+ * @member uint32_t workers -- work items in this run
+ * @member atomic_t started -- work items that have started
+ * @member atomic_t failed  -- allocations that failed
+ */
+typedef struct {
+    uint32_t workers;
+    atomic_t started;
+    atomic_t failed;
+} malloc_bench_run;
+
+/* Allocate and free small blocks of mixed sizes, like drivers do 
+ * during init.
+ *
+ * @param void *arg -- malloc_bench_run we're part of
+ */
+static void malloc_bench_worker(void *arg) {
+    malloc_bench_run *run = (malloc_bench_run *)arg;
+    void *ptrs[MALLOC_BENCH_DEPTH];
+
+    // Wait for everyone, so that each worker has a cpu of its own
+    atomic_inc(&run->started);
+    while (atomic_read(&run->started) < run->workers) {
+        cpu_relax();
+    }
+    for (uint32_t round = 0; round < MALLOC_BENCH_ROUNDS; round++) {
+        for (uint32_t i = 0; i < MALLOC_BENCH_DEPTH; i++) {
+            ptrs[i] = malloc(24 + (((round + i) * 40) % 232));
+        }
+        for (uint32_t i = 0; i < MALLOC_BENCH_DEPTH; i++) {
+            if (ptrs[i]) {
+                free(ptrs[i]);
+            } else {
+                atomic_inc(&run->failed);
+            }
+        }
+    }
+}
+
+/* Run benchmark on given amount of cpus
+ *
+ * @param uint32_t cpus -- amount of cpus to run on
+ * @param uint64_t *failed -- where to add failed allocations to
+ * @return uint64_t allocations and frees per millisecond
+ */
+static uint64_t malloc_bench_once(uint32_t cpus, uint64_t *failed) {
+    malloc_bench_run run = {
+        .workers = cpus,
+        .started = ATOMIC_INIT(0),
+        .failed = ATOMIC_INIT(0)
+    };
+    smp_work_group group = {
+        .pending = ATOMIC_INIT(0)
+    };
+
+    uint64_t start = now_ns();
+    for (uint32_t i = 0; i < cpus; i++) {
+        smp_queue_work(&group, malloc_bench_worker, &run);
+    }
+    smp_work_wait(&group);
+    uint64_t took = (now_ns() - start);
+
+    *failed += atomic_read(&run.failed);
+    uint64_t ops = ((uint64_t)cpus * MALLOC_BENCH_ROUNDS * MALLOC_BENCH_DEPTH * 2);
+    return (took ? ((ops * 1000000) / took) : 0);
+}
+
+/* Run allocation benchmark on 1 to all online cpus, with and without
+ * per-cpu caches, and print throughput for each. Needs smp_init() 
+ * done for more than one cpu.
+ */
+void malloc_bench(void) {
+    uint32_t online = (smp.cpu ? (uint32_t)atomic_read(&smp.online) : 1);
+    uint64_t failed = 0;
+
+    blogf("malloc bench, %u rounds of %u allocations per cpu\n", 
+            MALLOC_BENCH_ROUNDS, MALLOC_BENCH_DEPTH);
+    blogf("  cpus    cached ops/ms  uncached ops/ms\n");
+    for (uint32_t cpus = 1; cpus <= online; cpus++) {
+        heap_cache_enabled = true;
+        uint64_t cached = malloc_bench_once(cpus, &failed);
+        heap_cache_enabled = false;
+        uint64_t uncached = malloc_bench_once(cpus, &failed);
+        heap_cache_enabled = true;
+        blogf("  %4u  %15lu  %15lu\n", cpus, cached, uncached);
+    }
+    if (failed) {
+        blogf_warning("malloc bench: %lu allocations failed\n", failed);
+    }
+}
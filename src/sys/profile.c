@@ -0,0 +1,148 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2026, k4m1 <me@k4m1.net>
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+ 
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+ 
+ 3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <console/console.h>
+#include <cpu/common.h>
+
+#include <sys/profile.h>
+
+#include <time/clock.h>
+#include <time/timer.h>
+
+profile_state profile = {
+    .rip = 0
+};
+
+/* Record RIP interrupted by timer interrupt this callback runs from, 
+ * and re-arm for next sample.
+ *
+ * @param void *arg -- unused
+ */
+static void profile_sample(void *arg __attribute__((unused))) {
+    if (profile.count < PROFILE_MAX_SAMPLES) {
+        profile.samples[profile.count++] = profile.rip;
+    } else {
+        profile.dropped++;
+    }
+
+    // Keep rate steady even if timer fired late, but don't try to 
+    // catch up on samples we missed
+    uint64_t now = now_ns();
+    profile.next_ns += profile.period_ns;
+    if (profile.next_ns <= now) {
+        profile.next_ns = (now + profile.period_ns);
+    }
+    timer_add(&profile.sample_timer, profile.next_ns, profile_sample, NULL);
+}
+
+/* Allocate sample buffer and start sampling at CONFIG_PROFILE_HZ.
+ * Samples are taken from timer interrupt, so timers must be set up.
+ *
+ * @return bool true if profiler is running
+ */
+bool profile_init(void) {
+    profile.samples = malloc(PROFILE_MAX_SAMPLES * sizeof(uint64_t));
+    if (profile.samples == NULL) {
+        blogf_warning("No memory for profiler samples\n");
+        return false;
+    }
+    profile.period_ns = (1000000000ULL / CONFIG_PROFILE_HZ);
+    if (profile.period_ns < TIMER_TICK_NS) {
+        blogf_warning("Profiler rate capped to timer tick, %lu Hz\n", 
+                (uint64_t)(1000000000ULL / TIMER_TICK_NS));
+        profile.period_ns = TIMER_TICK_NS;
+    }
+    profile.next_ns = (now_ns() + profile.period_ns);
+    if (!timer_add(&profile.sample_timer, profile.next_ns, profile_sample, NULL)) {
+        free(profile.samples);
+        profile.samples = NULL;
+        return false;
+    }
+    blogf("Profiling every %lu us\n", (profile.period_ns / 1000));
+    return true;
+}
+
+/* Sort samples by RIP so same addresses can be counted together,
+ * shell sort is plenty for a few thousand.
+ *
+ * @param uint64_t *samples -- samples to sort
+ * @param uint32_t count    -- amount of samples
+ */
+static void profile_sort(uint64_t *samples, uint32_t count) {
+    for (uint32_t gap = (count / 2); gap > 0; gap /= 2) {
+        for (uint32_t i = gap; i < count; i++) {
+            uint64_t rip = samples[i];
+            uint32_t j = i;
+            while ((j >= gap) && (samples[j - gap] > rip)) {
+                samples[j] = samples[j - gap];
+                j -= gap;
+            }
+            samples[j] = rip;
+        }
+    }
+}
+
+/* Stop sampling and dump samples as "profile <rip> <count>" lines 
+ * for tools/profsym.py to symbolise.
+ */
+void profile_report(void) {
+    if (profile.samples == NULL) {
+        return;
+    }
+    bool int_enabled = interrupts_enabled();
+    cli();
+    timer_cancel(&profile.sample_timer);
+    uint32_t count = profile.count;
+    if (int_enabled) {
+        sti();
+    }
+
+    blogf("Profile: %u samples every %lu us, %u dropped\n", count,
+            (profile.period_ns / 1000), profile.dropped);
+    profile_sort(profile.samples, count);
+    uint32_t i = 0;
+    while (i < count) {
+        uint64_t rip = profile.samples[i];
+        uint32_t hits = 0;
+        while ((i < count) && (profile.samples[i] == rip)) {
+            hits++;
+            i++;
+        }
+        blogf("profile %lx %u\n", rip, hits);
+    }
+    free(profile.samples);
+    profile.samples = NULL;
+}
@@ -0,0 +1,169 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2026, k4m1 <me@k4m1.net>
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+ 
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+ 
+ 3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <cpu/common.h>
+
+#include <drivers/pit/pit.h>
+
+#include <mainboards/config.h>
+
+#include <time/clock.h>
+
+clock_state system_clock = {
+    .tsc_khz         = CLOCK_FALLBACK_TSC_KHZ,
+    .ns_mult         = CLOCK_NS_MULT(CLOCK_FALLBACK_TSC_KHZ),
+    .freq_source     = tsc_freq_fallback,
+    .tsc_timekeeping = true
+};
+
+static const char *clock_freq_source_names[] = {
+    [tsc_freq_fallback]   = "fallback",
+    [tsc_freq_mainboard]  = "mainboard",
+    [tsc_freq_hypervisor] = "hypervisor",
+    [tsc_freq_cpuid]      = "cpuid",
+    [tsc_freq_pit]        = "PIT calibration"
+};
+
+/* Switch clock over to given TSC frequency
+ *
+ * @param uint64_t khz                -- TSC frequency
+ * @param enum TSC_FREQ_SOURCE source -- where we got it from
+ */
+static void clock_set_tsc_khz(uint64_t khz, enum TSC_FREQ_SOURCE source) {
+    system_clock.tsc_khz = khz;
+    system_clock.ns_mult = CLOCK_NS_MULT(khz);
+    system_clock.freq_source = source;
+}
+
+/* Get TSC frequency from cpu itself. Only trusted with invariant TSC,
+ * otherwise the TSC rate follows whatever P-state we're in.
+ *
+ * @return uint64_t TSC frequency in kHz, or 0 if cpu doesn't tell
+ */
+static uint64_t clock_cpuid_tsc_khz(void) {
+    if (cpuid(CPUID_EXT_MAX, 0).eax < CPUID_EXT_POWER) {
+        return 0;
+    }
+    if ((cpuid(CPUID_EXT_POWER, 0).edx & CPUID_EXT_POWER_EDX_INVTSC) == 0) {
+        return 0;
+    }
+    uint32_t max = cpuid(0, 0).eax;
+    if (max >= CPUID_TSC_CRYSTAL) {
+        // TSC = crystal * ebx / eax
+        cpuid_result r = cpuid(CPUID_TSC_CRYSTAL, 0);
+        if (r.eax && r.ebx && r.ecx) {
+            return ((((uint64_t)r.ecx * r.ebx) / r.eax) / 1000);
+        }
+    }
+    if (max >= CPUID_CPU_FREQUENCY) {
+        // Invariant TSC runs at base frequency, eax is that in MHz
+        uint32_t base_mhz = cpuid(CPUID_CPU_FREQUENCY, 0).eax & 0xFFFF;
+        if (base_mhz) {
+            return ((uint64_t)base_mhz * 1000);
+        }
+    }
+    return 0;
+}
+
+/* Calibrate TSC against PIT channel 2. Anything that gets in between, 
+ * SMIs or vm exits, can only make a run take longer, so shortest run 
+ * is the most accurate one.
+ *
+ * @return uint64_t TSC frequency in kHz, or 0 if PIT doesn't work
+ */
+static uint64_t clock_pit_tsc_khz(void) {
+    uint64_t best = 0;
+    for (int run = 0; run < CLOCK_CALIBRATION_RUNS; run++) {
+        uint64_t ticks = pit_measure_tsc(CLOCK_CALIBRATION_PIT_TICKS);
+        if (ticks && ((best == 0) || (ticks < best))) {
+            best = ticks;
+        }
+    }
+    return ((best * PIT_FREQUENCY_HZ) / (CLOCK_CALIBRATION_PIT_TICKS * 1000ULL));
+}
+
+/* Find out TSC frequency. Mainboard configuration and cpuid are
+ * asked first, PIT calibration is only done if they don't know.
+ * Has to run before anything that needs accurate delays, and with 
+ * interrupts off.
+ *
+ * @return bool true if we know TSC frequency, false if we stay 
+ *              on the fallback frequency
+ */
+bool clock_init(void) {
+    uint64_t khz;
+    if ((khz = mainboard_tsc_khz())) {
+        clock_set_tsc_khz(khz, tsc_freq_mainboard);
+    } else if ((khz = cpuid_hypervisor_timing().eax)) {
+        clock_set_tsc_khz(khz, tsc_freq_hypervisor);
+    } else if ((khz = clock_cpuid_tsc_khz())) {
+        clock_set_tsc_khz(khz, tsc_freq_cpuid);
+    } else if ((khz = clock_pit_tsc_khz())) {
+        clock_set_tsc_khz(khz, tsc_freq_pit);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/* Get name of where TSC frequency came from, for logging
+ *
+ * @param enum TSC_FREQ_SOURCE source -- frequency source
+ * @return const char * name
+ */
+const char *clock_freq_source_name(enum TSC_FREQ_SOURCE source) {
+    return clock_freq_source_names[source];
+}
+
+/* Busy wait for given amount of nanoseconds
+ *
+ * @param uint32_t ns -- nanoseconds to wait
+ */
+void ndelay(uint32_t ns) {
+    uint64_t deadline = deadline_ns(ns);
+    while (!deadline_passed(deadline)) {
+        cpu_relax();
+    }
+}
+
+/* Busy wait for given amount of microseconds
+ *
+ * @param uint32_t us -- microseconds to wait
+ */
+void udelay(uint32_t us) {
+    uint64_t deadline = deadline_us(us);
+    while (!deadline_passed(deadline)) {
+        cpu_relax();
+    }
+}
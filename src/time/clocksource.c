@@ -0,0 +1,250 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2026, k4m1 <me@k4m1.net>
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+ 
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+ 
+ 3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <sys/io.h>
+#include <cpu/common.h>
+
+#include <drivers/device.h>
+#include <drivers/pit/pit.h>
+
+#include <mainboards/config.h>
+#include <mm/paging.h>
+
+#include <console/console.h>
+
+#include <time/clock.h>
+#include <time/clocksource.h>
+
+static clocksource clocksources[CLOCKSOURCE_MAX];
+static uint8_t clocksource_count = 0;
+
+clocksource *system_clocksource = NULL;
+
+static uint64_t clocksource_read_tsc(clocksource *cs __attribute__((unused))) {
+    return rdtsc();
+}
+
+static uint64_t clocksource_read_pit(clocksource *cs __attribute__((unused))) {
+    // Channel 2 counts down, flip it around
+    return (uint16_t)(0 - pit_ch2_read());
+}
+
+static uint64_t clocksource_read_acpi_pm(clocksource *cs) {
+    return (inl((unsigned short)cs->base) & ACPI_PM_TIMER_MASK);
+}
+
+static uint64_t clocksource_read_hpet(clocksource *cs) {
+    return *(volatile uint64_t *)(cs->base + HPET_REG_COUNTER);
+}
+
+/* Measure how long reading a clocksource takes, in TSC time
+ *
+ * @param clocksource *cs -- clocksource to measure
+ * @return uint32_t nanoseconds per read
+ */
+static uint32_t clocksource_measure_read_cost(clocksource *cs) {
+    uint64_t start = rdtsc();
+    for (int i = 0; i < CLOCKSOURCE_COST_SAMPLES; i++) {
+        cs->read(cs);
+    }
+    uint64_t ns = clock_ticks_to_ns(rdtsc() - start);
+    return (uint32_t)(ns / CLOCKSOURCE_COST_SAMPLES);
+}
+
+/* Add a counter to our list of clocksources
+ *
+ * @param char *name        -- name for logging
+ * @param read              -- function to read raw counter with
+ * @param uint64_t base     -- i/o port or mmio address of counter
+ * @param uint64_t mask     -- counter width
+ * @param uint64_t freq_hz  -- counter frequency
+ * @return clocksource * or NULL if we're out of slots
+ */
+static clocksource *clocksource_register(char *name, uint64_t (*read)(clocksource *cs), 
+        uint64_t base, uint64_t mask, uint64_t freq_hz) {
+    if ((clocksource_count == CLOCKSOURCE_MAX) || (freq_hz == 0)) {
+        return NULL;
+    }
+    clocksource *cs = &clocksources[clocksource_count++];
+    cs->name = name;
+    cs->read = read;
+    cs->base = base;
+    cs->mask = mask;
+    cs->freq_hz = freq_hz;
+    cs->ns_mult = ((1000000000ULL << CLOCKSOURCE_NS_SHIFT) / freq_hz);
+    cs->resolution_ns = (uint32_t)((1000000000ULL + freq_hz - 1) / freq_hz);
+    cs->read_cost_ns = clocksource_measure_read_cost(cs);
+    cs->last = read(cs);
+    cs->cycles = 0;
+    cs->base_ns = 0;
+    return cs;
+}
+
+/* Check if HPET is there and start its main counter
+ */
+static void clocksource_probe_hpet(void) {
+    uint64_t base = mainboard_hpet_base();
+    if ((base == 0) || (map_address((void *)base, 0x1000) == false)) {
+        return;
+    }
+    uint64_t cap = *(volatile uint64_t *)(base + HPET_REG_CAPABILITIES);
+    uint64_t period_fs = (cap >> 32);
+    if ((period_fs == 0) || (period_fs > HPET_MAX_PERIOD_FS)) {
+        return;
+    }
+    volatile uint64_t *config = (volatile uint64_t *)(base + HPET_REG_CONFIG);
+    *config |= HPET_CONFIG_ENABLE;
+
+    uint64_t mask = (cap & HPET_CAP_COUNT_SIZE_64) ? ~0ULL : 0xFFFFFFFFULL;
+    clocksource_register("HPET", clocksource_read_hpet, base, mask, 
+            (1000000000000000ULL / period_fs));
+}
+
+/* Check if ACPI PM timer is there. Nothing in i/o space where it 
+ * should be reads as all ones and doesn't move.
+ *
+ * @param device **pci_devs -- pci devices we've found
+ * @param uint8_t count     -- amount of pci devices
+ */
+static void clocksource_probe_acpi_pm(device **pci_devs, uint8_t count) {
+    uint16_t pm_base = mainboard_acpi_pm_base(pci_devs, count);
+    if (pm_base == 0) {
+        return;
+    }
+    uint16_t port = (pm_base + ACPI_PM_TIMER_OFFSET);
+    uint32_t first = (inl(port) & ACPI_PM_TIMER_MASK);
+    udelay(10);
+    if ((inl(port) & ACPI_PM_TIMER_MASK) == first) {
+        return;
+    }
+    clocksource_register("ACPI PM", clocksource_read_acpi_pm, port, 
+            ACPI_PM_TIMER_MASK, ACPI_PM_TIMER_HZ);
+}
+
+/* Find counters we have, measure them and pick the best one for
+ * now_ns(). Best is the one with smallest of max(resolution, read cost).
+ *
+ * @param device **pci_devs -- pci devices we've found
+ * @param uint8_t count     -- amount of pci devices
+ * @return clocksource * we picked
+ */
+clocksource *clocksource_init(device **pci_devs, uint8_t count) {
+    // TSC is only any good if we know how fast it goes
+    if (system_clock.freq_source != tsc_freq_fallback) {
+        clocksource_register("TSC", clocksource_read_tsc, 0, ~0ULL, 
+                (system_clock.tsc_khz * 1000));
+    }
+    clocksource_probe_hpet();
+    clocksource_probe_acpi_pm(pci_devs, count);
+    pit_ch2_free_run();
+    clocksource_register("PIT", clocksource_read_pit, pit_channel_2_port, 0xFFFF, 
+            PIT_FREQUENCY_HZ);
+
+    clocksource *best = NULL;
+    uint32_t best_score = 0;
+    for (uint8_t i = 0; i < clocksource_count; i++) {
+        clocksource *cs = &clocksources[i];
+        uint32_t score = (cs->resolution_ns > cs->read_cost_ns) ? 
+            cs->resolution_ns : cs->read_cost_ns;
+        blogf_debug("clocksource %-8s %10lu Hz, resolution %u ns, read %u ns\n",
+                cs->name, cs->freq_hz, cs->resolution_ns, cs->read_cost_ns);
+        if ((best == NULL) || (score < best_score)) {
+            best = cs;
+            best_score = score;
+        }
+    }
+
+    // Carry on from where TSC based now_ns() was
+    best->base_ns = now_ns();
+    best->last = best->read(best);
+    best->cycles = 0;
+    system_clocksource = best;
+    system_clock.tsc_timekeeping = (best->read == clocksource_read_tsc);
+    blogf("Using %s as clocksource\n", best->name);
+    return best;
+}
+
+/* Read clocksource and extend it to 64 bits
+ *
+ * @param clocksource *cs -- clocksource to read
+ * @return uint64_t cycles since we started reading it
+ */
+uint64_t clocksource_cycles(clocksource *cs) {
+    bool int_enabled = interrupts_enabled();
+    cli();
+    uint64_t now = cs->read(cs);
+    cs->cycles += ((now - cs->last) & cs->mask);
+    cs->last = now;
+    uint64_t ret = cs->cycles;
+    if (int_enabled) {
+        sti();
+    }
+    return ret;
+}
+
+/* Get time since reset from system clocksource
+ *
+ * @return uint64_t nanoseconds since reset
+ */
+uint64_t clocksource_now_ns(void) {
+    clocksource *cs = system_clocksource;
+    if (cs == NULL) {
+        return clock_ticks_to_ns(rdtsc());
+    }
+    uint64_t cycles = clocksource_cycles(cs);
+    return (cs->base_ns + 
+            (uint64_t)(((unsigned __int128)cycles * cs->ns_mult) >> CLOCKSOURCE_NS_SHIFT));
+}
+
+/* Get longest time we can go without reading system clocksource. 
+ * That's half of the wrap period, leaving slack for late interrupts.
+ *
+ * @return uint64_t nanoseconds, UINT64_MAX if it doesn't wrap in practice
+ */
+uint64_t clocksource_max_idle_ns(void) {
+    clocksource *cs = system_clocksource;
+    if ((cs == NULL) || (cs->mask == ~0ULL)) {
+        return UINT64_MAX;
+    }
+    return (uint64_t)((((unsigned __int128)cs->mask + 1) * cs->ns_mult) >> (CLOCKSOURCE_NS_SHIFT + 1));
+}
+
+/* Keep system clocksource from wrapping unnoticed, called from 
+ * timer interrupt.
+ */
+void __attribute__((no_caller_saved_registers)) clocksource_tick(void) {
+    if (system_clocksource) {
+        clocksource_cycles(system_clocksource);
+    }
+}
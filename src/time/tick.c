@@ -0,0 +1,191 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2026, k4m1 <me@k4m1.net>
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+ 
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+ 
+ 3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <console/console.h>
+#include <cpu/common.h>
+
+#include <drivers/device.h>
+#include <drivers/lapic/lapic.h>
+#include <drivers/pic_8259/pic.h>
+#include <drivers/pit/pit.h>
+
+#include <time/clock.h>
+#include <time/clocksource.h>
+#include <time/tick.h>
+#include <time/timer.h>
+
+tick_state ticks = {
+    .armed_at = UINT64_MAX
+};
+
+static void __attribute__((no_caller_saved_registers)) tick_arm_lapic(uint64_t delta_ns) {
+    uint64_t count = ((delta_ns * local_apic->timer_khz) / 1000000);
+    if (count == 0) {
+        count = 1;
+    }
+    lapic_timer_oneshot((uint32_t)count);
+}
+
+static void __attribute__((no_caller_saved_registers)) tick_arm_pit(uint64_t delta_ns) {
+    uint64_t count = ((delta_ns * PIT_FREQUENCY_HZ) / 1000000000);
+    if (count == 0) {
+        count = 1;
+    }
+    pit_oneshot((uint16_t)count);
+}
+
+static tick_device tick_lapic = {
+    .name = "LAPIC timer",
+    .arm  = tick_arm_lapic
+};
+
+static tick_device tick_pit = {
+    .name = "PIT",
+    .arm  = tick_arm_pit,
+    .max_delta_ns = ((0xFFFFULL * 1000000000) / PIT_FREQUENCY_HZ)
+};
+
+/* Arm timer interrupt for given time, or not at all if nothing is
+ * waiting for it. Interrupts must be disabled.
+ *
+ * @param uint64_t deadline -- now_ns() value, UINT64_MAX for none
+ */
+static void __attribute__((no_caller_saved_registers)) tick_program(uint64_t deadline) {
+    // Clocksource must be read before it wraps twice
+    uint64_t max_idle = clocksource_max_idle_ns();
+    if ((deadline == UINT64_MAX) && (max_idle == UINT64_MAX)) {
+        ticks.armed_at = UINT64_MAX;
+        return;
+    }
+    uint64_t now = now_ns();
+    uint64_t delta = (deadline > now) ? (deadline - now) : 0;
+    if (delta > max_idle) {
+        delta = max_idle;
+    }
+    if (delta > ticks.dev->max_delta_ns) {
+        delta = ticks.dev->max_delta_ns;
+    }
+    if (delta < TICK_MIN_DELTA_NS) {
+        delta = TICK_MIN_DELTA_NS;
+    }
+    ticks.armed_at = (now + delta);
+    ticks.dev->arm(delta);
+}
+
+/* Arm timer interrupt for first pending timer, unless it's armed for
+ * that already. Interrupts must be disabled.
+ */
+static void __attribute__((no_caller_saved_registers)) tick_program_next(void) {
+    uint64_t deadline = timer_next_deadline();
+    if ((ticks.armed_at != UINT64_MAX) && (ticks.armed_at <= deadline)) {
+        return;
+    }
+    tick_program(deadline);
+}
+
+/* Pick one-shot timer interrupt source, local apic timer if there's
+ * one, PIT otherwise, and arm it for first pending timer.
+ *
+ * @return bool true if we have a tick device
+ */
+bool tick_init(void) {
+    bool int_enabled = interrupts_enabled();
+    cli();
+    pit_oneshot_mode();
+    if (local_apic) {
+        // PIT stays quiet in one-shot mode until armed
+        pic_mask_irq(0);
+        tick_lapic.max_delta_ns = ((0xFFFFFFFFULL * 1000000) / local_apic->timer_khz);
+        ticks.dev = &tick_lapic;
+    } else {
+        pic_unmask_irq(0);
+        ticks.dev = &tick_pit;
+    }
+    ticks.window_start = now_ns();
+    tick_program(timer_next_deadline());
+    if (int_enabled) {
+        sti();
+    }
+    blogf("Using %s for tickless timer interrupts\n", ticks.dev->name);
+    return true;
+}
+
+/* Make sure timer interrupt comes no later than given deadline,
+ * called with interrupts disabled when timers are armed.
+ *
+ * @param uint64_t deadline -- now_ns() value
+ */
+void __attribute__((no_caller_saved_registers)) tick_update(uint64_t deadline) {
+    if ((ticks.dev == NULL) || (deadline >= ticks.armed_at)) {
+        return;
+    }
+    tick_program(deadline);
+}
+
+/* Run clocksource and timers, and arm interrupt for next deadline.
+ * Called from timer interrupt handler, which sends EOI.
+ */
+void __attribute__((no_caller_saved_registers)) tick_handle_interrupt(void) {
+    ticks.armed_at = UINT64_MAX;
+    clocksource_tick();
+    timer_run();
+    if (ticks.dev) {
+        tick_program_next();
+    }
+}
+
+/* Sleep until next interrupt, timer interrupt is programmed for 
+ * first pending timer so this may sleep for long.
+ */
+void idle(void) {
+    cli();
+    if (ticks.dev) {
+        tick_program_next();
+    }
+    sti_halt();
+
+    ticks.wakeups++;
+    uint64_t now = now_ns();
+    uint64_t elapsed = (now - ticks.window_start);
+    if (elapsed >= TICK_STATS_WINDOW_NS) {
+        uint64_t per_sec = (((ticks.wakeups - ticks.window_wakeups) * TICK_STATS_WINDOW_NS) / elapsed);
+        if (per_sec != ticks.wakeups_per_sec) {
+            blogf_debug("%lu wakeups/s\n", per_sec);
+        }
+        ticks.wakeups_per_sec = per_sec;
+        ticks.window_start = now;
+        ticks.window_wakeups = ticks.wakeups;
+    }
+}
@@ -0,0 +1,271 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2026, k4m1 <me@k4m1.net>
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+ 
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+ 
+ 3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <cpu/common.h>
+
+#include <time/clock.h>
+#include <time/tick.h>
+#include <time/timer.h>
+
+static timer_wheel *wheel = NULL;
+
+static inline void timer_list_init(timer_list *head) {
+    head->next = head;
+    head->prev = head;
+}
+
+static inline bool timer_list_empty(timer_list *head) {
+    return (head->next == head);
+}
+
+static inline void timer_list_add(timer_list *head, timer_list *node) {
+    node->next = head;
+    node->prev = head->prev;
+    head->prev->next = node;
+    head->prev = node;
+}
+
+static inline void timer_list_del(timer_list *node) {
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->next = node;
+    node->prev = node;
+}
+
+/* Put timer on the slot matching its expiry. Level is picked by how
+ * far away expiry is, slot within level by expiry itself, so that it 
+ * gets cascaded down exactly when lower levels wrap around to it.
+ *
+ * @param timer *t -- timer to queue, expires must be set
+ */
+static void timer_enqueue(timer *t) {
+    uint64_t expires = t->expires;
+    if (expires < wheel->tick) {
+        expires = wheel->tick;
+    }
+    uint64_t delta = (expires - wheel->tick);
+    if (delta >= TIMER_WHEEL_RANGE) {
+        expires = (wheel->tick + (TIMER_WHEEL_RANGE - 1));
+        delta = (TIMER_WHEEL_RANGE - 1);
+    }
+    int level = 0;
+    while (delta >= (1ULL << (TIMER_WHEEL_BITS * (level + 1)))) {
+        level++;
+    }
+    uint64_t idx = ((expires >> (TIMER_WHEEL_BITS * level)) & TIMER_WHEEL_MASK);
+    timer_list_add(&wheel->slot[level][idx], &t->node);
+}
+
+/* Move everything from a slot back through timer_enqueue(), they're
+ * now close enough to land on lower levels.
+ *
+ * @param int level -- level to cascade from
+ */
+static void timer_cascade(int level) {
+    uint64_t idx = ((wheel->tick >> (TIMER_WHEEL_BITS * level)) & TIMER_WHEEL_MASK);
+    timer_list *head = &wheel->slot[level][idx];
+    while (!timer_list_empty(head)) {
+        timer *t = (timer *)head->next;
+        timer_list_del(&t->node);
+        timer_enqueue(t);
+    }
+}
+
+/* Find first tick at which wheel has something to do, either fire
+ * timers on level 0 or cascade a non-empty slot of upper level. Ticks
+ * before that can be skipped over.
+ *
+ * @return uint64_t tick, UINT64_MAX if wheel is empty
+ */
+static uint64_t timer_next_tick(void) {
+    uint64_t next = UINT64_MAX;
+    for (uint64_t i = 0; i < TIMER_WHEEL_SLOTS; i++) {
+        if (!timer_list_empty(&wheel->slot[0][((wheel->tick + i) & TIMER_WHEEL_MASK)])) {
+            next = (wheel->tick + i);
+            break;
+        }
+    }
+    for (int level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+        uint64_t shift = (TIMER_WHEEL_BITS * level);
+        uint64_t block = (wheel->tick >> shift);
+        // Slot of current block was cascaded already unless we're
+        // exactly at its start
+        if (wheel->tick & ((1ULL << shift) - 1)) {
+            block++;
+        }
+        for (uint64_t i = 0; i < TIMER_WHEEL_SLOTS; i++) {
+            uint64_t at = ((block + i) << shift);
+            if (at >= next) {
+                break;
+            }
+            if (!timer_list_empty(&wheel->slot[level][((block + i) & TIMER_WHEEL_MASK)])) {
+                next = at;
+                break;
+            }
+        }
+    }
+    return next;
+}
+
+/* Set up timer wheel, timers can't be armed before this.
+ *
+ * @return bool true on success, false if we're out of memory
+ */
+bool timer_init(void) {
+    wheel = malloc(sizeof(timer_wheel));
+    if (wheel == NULL) {
+        return false;
+    }
+    for (int level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+        for (int idx = 0; idx < TIMER_WHEEL_SLOTS; idx++) {
+            timer_list_init(&wheel->slot[level][idx]);
+        }
+    }
+    wheel->tick = (now_ns() / TIMER_TICK_NS);
+    return true;
+}
+
+/* Arm a timer. Timer that's already pending gets moved to new deadline.
+ *
+ * @param timer *t            -- timer to arm
+ * @param uint64_t deadline   -- now_ns() value to fire at
+ * @param timer_callback cb   -- function to call
+ * @param void *arg           -- argument to pass to callback
+ * @return bool true if timer was armed
+ */
+bool timer_add(timer *t, uint64_t deadline, timer_callback cb, void *arg) {
+    if (wheel == NULL) {
+        return false;
+    }
+    bool int_enabled = interrupts_enabled();
+    cli();
+    if (t->pending) {
+        timer_list_del(&t->node);
+    }
+    t->expires = ((deadline + (TIMER_TICK_NS - 1)) / TIMER_TICK_NS);
+    t->cb = cb;
+    t->arg = arg;
+    t->pending = true;
+    timer_enqueue(t);
+    tick_update(t->expires * TIMER_TICK_NS);
+    if (int_enabled) {
+        sti();
+    }
+    return true;
+}
+
+/* Disarm a timer
+ *
+ * @param timer *t -- timer to cancel
+ * @return bool true if timer was pending
+ */
+bool timer_cancel(timer *t) {
+    bool int_enabled = interrupts_enabled();
+    cli();
+    bool was_pending = t->pending;
+    if (was_pending) {
+        timer_list_del(&t->node);
+        t->pending = false;
+    }
+    if (int_enabled) {
+        sti();
+    }
+    return was_pending;
+}
+
+/* Get time at which wheel next needs timer_run(), for programming
+ * one-shot timer interrupt. Cascades count too, so this may be early.
+ *
+ * @return uint64_t now_ns() value, UINT64_MAX if nothing is pending
+ */
+uint64_t timer_next_deadline(void) {
+    if (wheel == NULL) {
+        return UINT64_MAX;
+    }
+    uint64_t next = timer_next_tick();
+    if (next == UINT64_MAX) {
+        return UINT64_MAX;
+    }
+    return (next * TIMER_TICK_NS);
+}
+
+/* Fire every timer that's due, called from timer interrupt. Ticks 
+ * come from now_ns(), so late or missed interrupts just mean several
+ * ticks get processed at once. Ticks with nothing to do are skipped,
+ * after a long idle sleep we don't walk through them one by one.
+ */
+void __attribute__((no_caller_saved_registers)) timer_run(void) {
+    if (wheel == NULL) {
+        return;
+    }
+    uint64_t now = (now_ns() / TIMER_TICK_NS);
+    while (wheel->tick <= now) {
+        uint64_t next = timer_next_tick();
+        if (next > now) {
+            wheel->tick = (now + 1);
+            break;
+        }
+        wheel->tick = next;
+
+        // Upper levels cascade down when everything below wraps
+        for (int level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+            if (wheel->tick & ((1ULL << (TIMER_WHEEL_BITS * level)) - 1)) {
+                break;
+            }
+            timer_cascade(level);
+        }
+
+        // Take expired timers off the wheel before advancing, so that
+        // callbacks re-arming themselves land on a later tick.
+        timer_list expired;
+        timer_list *head = &wheel->slot[0][(wheel->tick & TIMER_WHEEL_MASK)];
+        timer_list_init(&expired);
+        if (!timer_list_empty(head)) {
+            expired.next = head->next;
+            expired.prev = head->prev;
+            expired.next->prev = &expired;
+            expired.prev->next = &expired;
+            timer_list_init(head);
+        }
+        wheel->tick++;
+
+        while (!timer_list_empty(&expired)) {
+            timer *t = (timer *)expired.next;
+            timer_list_del(&t->node);
+            t->pending = false;
+            t->cb(t->arg);
+        }
+    }
+}
@@ -0,0 +1,185 @@
+/*
+ BSD 3-Clause License
+ 
+ Copyright (c) 2026, k4m1 <me@k4m1.net>
+ All rights reserved.
+ 
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+ 
+ 1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+ 
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+ 
+ 3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+ 
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <console/console.h>
+#include <cpu/common.h>
+
+#include <mainboards/memory_init.h>
+
+#include <time/clock.h>
+#include <time/timestamp.h>
+
+static timestamp_table *const ts_table = (timestamp_table *)TIMESTAMP_BASE;
+
+/* Record timestamp with given TSC value
+ *
+ * @param enum TIMESTAMP_ID id -- milestone
+ * @param const char *tag      -- what it's about, NULL for nothing
+ * @param uint64_t tsc         -- when
+ */
+static void timestamp_record(enum TIMESTAMP_ID id, const char *tag, uint64_t tsc) {
+    if (ts_table->count >= ts_table->max) {
+        ts_table->dropped++;
+        return;
+    }
+    timestamp_entry *ent = &ts_table->entry[ts_table->count];
+    ent->tsc = tsc;
+    ent->id = id;
+    size_t i = 0;
+    if (tag) {
+        for (; (i < (TIMESTAMP_TAG_LEN - 1)) && tag[i]; i++) {
+            ent->tag[i] = tag[i];
+        }
+    }
+    for (; i < TIMESTAMP_TAG_LEN; i++) {
+        ent->tag[i] = 0;
+    }
+    ts_table->count++;
+}
+
+/* Set up timestamp table and move stamps taken before we had memory
+ * from MMX registers into it. First thing c_main() does.
+ */
+void timestamp_init(void) {
+    uint64_t reset, car_up, memory_up;
+    asm volatile(
+        "movq   %0, mm0;"
+        "movq   %1, mm1;"
+        "movq   %2, mm2;"
+        "emms;"
+        : "=r"(reset), "=r"(car_up), "=r"(memory_up)
+    );
+    uint64_t now = rdtsc();
+
+    memcpy(TIMESTAMP_SIGNATURE, ts_table->signature, sizeof(ts_table->signature));
+    ts_table->version = TIMESTAMP_VERSION;
+    ts_table->count = 0;
+    ts_table->max = ((TIMESTAMP_SIZE - sizeof(timestamp_table)) / sizeof(timestamp_entry));
+    ts_table->dropped = 0;
+    ts_table->tsc_khz = 0;
+
+    timestamp_record(ts_reset, "reset vector", reset);
+    timestamp_record(ts_car_up, "cache as ram", car_up);
+    timestamp_record(ts_memory_up, "main memory", memory_up);
+    timestamp_record(ts_c_main, "c_main", now);
+}
+
+/* Record TSC for a boot milestone
+ *
+ * @param enum TIMESTAMP_ID id -- milestone
+ * @param const char *tag      -- what it's about, NULL for nothing
+ */
+void timestamp(enum TIMESTAMP_ID id, const char *tag) {
+    timestamp_record(id, tag, rdtsc());
+}
+
+/* Add timestamp table to memory map as reserved
+ *
+ * @param memory_map *map -- memory map to add region to
+ */
+void timestamp_reserve(memory_map *map) {
+    mmap_reserve(map, TIMESTAMP_BASE, TIMESTAMP_SIZE);
+}
+
+/* Find start of a stage that ended at given entry. Start ids are one
+ * below matching end ids.
+ *
+ * @param uint16_t end -- index of end entry
+ * @return timestamp_entry * start, or NULL if there's none
+ */
+static timestamp_entry *timestamp_find_start(uint16_t end) {
+    timestamp_entry *e = &ts_table->entry[end];
+    for (int i = (end - 1); i >= 0; i--) {
+        timestamp_entry *s = &ts_table->entry[i];
+        if ((s->id == (e->id - 1)) && 
+                (strncmp((unsigned char *)s->tag, (unsigned char *)e->tag, TIMESTAMP_TAG_LEN) == 0)) {
+            return s;
+        }
+    }
+    return NULL;
+}
+
+static inline bool timestamp_is_start(uint32_t id) {
+    return ((id == ts_device_start) || (id == ts_pci_start) || (id == ts_ata_start));
+}
+
+static inline bool timestamp_is_end(uint32_t id) {
+    return ((id == ts_device_end) || (id == ts_pci_end) || (id == ts_ata_end));
+}
+
+/* Print how long each stage took and how much of total boot time.
+ * Milestones show time since previous milestone, things with start
+ * and end show time between the two. Concurrent stages overlap, so
+ * their shares may add up to more than 100%.
+ */
+void timestamp_report(void) {
+    ts_table->tsc_khz = system_clock.tsc_khz;
+    if (ts_table->count < 2) {
+        return;
+    }
+    uint64_t base = ts_table->entry[0].tsc;
+    uint64_t total_ns = clock_ticks_to_ns(ts_table->entry[ts_table->count - 1].tsc - base);
+    if (total_ns == 0) {
+        return;
+    }
+    blogf("Boot timeline, %lu us from reset vector (%lu us after power on):\n", 
+            (total_ns / 1000), (clock_ticks_to_ns(base) / 1000));
+    blogf("  %-20s %10s %10s %7s\n", "stage", "at us", "took us", "share");
+
+    uint64_t prev = base;
+    for (uint16_t i = 1; i < ts_table->count; i++) {
+        timestamp_entry *e = &ts_table->entry[i];
+        uint64_t from;
+        if (timestamp_is_start(e->id)) {
+            continue;
+        } else if (timestamp_is_end(e->id)) {
+            timestamp_entry *s = timestamp_find_start(i);
+            from = s ? s->tsc : e->tsc;
+        } else {
+            from = prev;
+            prev = e->tsc;
+        }
+        uint64_t took_ns = clock_ticks_to_ns(e->tsc - from);
+        uint64_t permille = ((took_ns * 1000) / total_ns);
+        blogf("  %-20s %10lu %10lu %3lu.%lu%%\n", e->tag, 
+                (clock_ticks_to_ns(e->tsc - base) / 1000), (took_ns / 1000),
+                (permille / 10), (permille % 10));
+    }
+    if (ts_table->dropped) {
+        blogf_warning("%d boot timestamps didn't fit in table\n", ts_table->dropped);
+    }
+}
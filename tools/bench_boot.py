@@ -0,0 +1,190 @@
+#!/usr/bin/env python3
+#
+# BSD 3-Clause License
+#
+# Copyright (c) 2026, k4m1 <me@k4m1.net>
+# All rights reserved.
+#
+# See LICENSE in the root of this repository for full license text.
+#
+# Boot time benchmark.
+#
+# Boots tinybios.bin headless in QEMU a number of times, reads the boot
+# timeline that timestamp_report() prints at end of POST from debugcon,
+# and reports median and percentiles per stage. Stages whose median got
+# slower than baseline by more than given threshold fail the run. If
+# there's no baseline yet, current results are saved as one.
+#
+# Usage:
+#   bench_boot.py --bios build/tinybios.bin --disk test_disk
+#   bench_boot.py --bios build/tinybios.bin --elf build/tinybios.elf \
+#       --baseline bench_boot_baseline.json --threshold 10 --runs 9
+#
+import argparse
+import json
+import math
+import os
+import re
+import shlex
+import subprocess
+import sys
+import tempfile
+import time
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import blogdecode
+
+# Row of timeline table, see timestamp_report()
+ROW = re.compile(r"^\s+(.+?)\s+(\d+)\s+(\d+)\s+\d+\.\d%\s*$")
+DONE_TAG = b"POST done"
+TOTAL = "total"
+
+def percentile(values, pct):
+    """Nearest rank percentile of a list of numbers."""
+    ordered = sorted(values)
+    rank = math.ceil((pct / 100.0) * len(ordered))
+    return ordered[max(0, min(len(ordered), rank) - 1)]
+
+def boot_once(args, fmt_table):
+    """Boot once, return {stage: took_us} parsed from the timeline."""
+    with tempfile.NamedTemporaryFile(prefix="tinybios-debugcon-", delete=False) as f:
+        log_path = f.name
+    cmd = [args.qemu, "-bios", args.bios, "-display", "none", "-serial", "none",
+           "-monitor", "none", "-no-reboot", "-debugcon", f"file:{log_path}"]
+    if args.disk:
+        cmd += ["-device", "piix3-ide,id=ide",
+                "-drive", f"id=disk,file={args.disk},format=raw,if=none,snapshot=on",
+                "-device", "ide-hd,drive=disk,bus=ide.0"]
+    cmd += shlex.split(args.qemu_args)
+
+    proc = subprocess.Popen(cmd, stdin=subprocess.DEVNULL, stdout=subprocess.DEVNULL)
+    deadline = time.monotonic() + args.timeout
+    data = b""
+    try:
+        while time.monotonic() < deadline and proc.poll() is None:
+            time.sleep(0.1)
+            with open(log_path, "rb") as f:
+                data = f.read()
+            if DONE_TAG in data:
+                # Whole report goes out in one go, give it a moment
+                time.sleep(0.2)
+                with open(log_path, "rb") as f:
+                    data = f.read()
+                break
+    finally:
+        proc.kill()
+        proc.wait()
+        os.unlink(log_path)
+
+    if DONE_TAG not in data:
+        raise SystemExit(f"boot did not finish POST within {args.timeout}s:\n{' '.join(cmd)}")
+    if fmt_table is not None:
+        out = _Collect()
+        blogdecode.decode(fmt_table, data, out, False)
+        text = out.text
+    else:
+        text = data.decode(errors="replace")
+
+    stages = {}
+    in_table = False
+    for line in text.splitlines():
+        if line.startswith("Boot timeline"):
+            in_table = True
+            stages = {}
+            continue
+        if not in_table:
+            continue
+        m = ROW.match(line)
+        if not m:
+            continue
+        tag, at_us, took_us = m.group(1), int(m.group(2)), int(m.group(3))
+        stages[tag] = took_us
+        if tag == DONE_TAG.decode():
+            stages[TOTAL] = at_us
+            break
+    if TOTAL not in stages:
+        raise SystemExit("could not find boot timeline in debugcon output")
+    return stages
+
+class _Collect:
+    def __init__(self):
+        self.text = ""
+
+    def write(self, s):
+        self.text += s
+
+def main():
+    ap = argparse.ArgumentParser(description="Benchmark TinyBIOS boot time under QEMU")
+    ap.add_argument("--bios", required=True, help="tinybios.bin to boot")
+    ap.add_argument("--elf", help="tinybios.elf, needed to decode binary logs")
+    ap.add_argument("--disk", help="raw disk image to attach to primary IDE")
+    ap.add_argument("--qemu", default="qemu-system-x86_64")
+    ap.add_argument("--qemu-args", default="", help="extra arguments for QEMU")
+    ap.add_argument("--runs", type=int, default=7)
+    ap.add_argument("--timeout", type=float, default=60.0, help="seconds to wait per boot")
+    ap.add_argument("--percentiles", default="50,90,99")
+    ap.add_argument("--baseline", help="json file with baseline medians")
+    ap.add_argument("--update-baseline", action="store_true", help="save results as new baseline")
+    ap.add_argument("--threshold", type=float, default=10.0,
+                    help="fail if stage median is this many percent over baseline")
+    ap.add_argument("--min-delta-us", type=int, default=200,
+                    help="ignore regressions smaller than this, short stages are noisy")
+    args = ap.parse_args()
+
+    fmt_table = None
+    if args.elf:
+        try:
+            fmt_table = blogdecode.elf_section(args.elf, ".blog_fmt")
+        except SystemExit:
+            fmt_table = None
+
+    samples = {}
+    order = []
+    for run in range(args.runs):
+        stages = boot_once(args, fmt_table)
+        for tag, took in stages.items():
+            if tag not in samples:
+                samples[tag] = []
+                order.append(tag)
+            samples[tag].append(took)
+        print(f"run {run + 1}/{args.runs}: {stages[TOTAL]} us", file=sys.stderr)
+
+    pcts = [float(p) for p in args.percentiles.split(",") if p]
+    header = f"{'stage':<20} " + " ".join(f"{'p' + format(p, 'g'):>9}" for p in pcts)
+    header += f" {'min':>9} {'max':>9}  (us, {args.runs} runs)"
+    print(header)
+    medians = {}
+    for tag in order:
+        vals = samples[tag]
+        medians[tag] = percentile(vals, 50)
+        cols = " ".join(f"{percentile(vals, p):>9}" for p in pcts)
+        print(f"{tag:<20} {cols} {min(vals):>9} {max(vals):>9}")
+
+    if not args.baseline:
+        return 0
+    if args.update_baseline or not os.path.exists(args.baseline):
+        with open(args.baseline, "w") as f:
+            json.dump(medians, f, indent=2, sort_keys=True)
+        print(f"Saved baseline to {args.baseline}")
+        return 0
+
+    with open(args.baseline) as f:
+        baseline = json.load(f)
+    failed = False
+    for tag, base in sorted(baseline.items()):
+        if tag not in medians:
+            print(f"warning: stage {tag} not seen any more", file=sys.stderr)
+            continue
+        now = medians[tag]
+        limit = base * (1.0 + (args.threshold / 100.0))
+        if now > limit and (now - base) > args.min_delta_us:
+            print(f"REGRESSION: {tag} median {now} us, baseline {base} us "
+                  f"(+{((now - base) * 100.0) / max(base, 1):.1f}%, threshold {args.threshold:g}%)")
+            failed = True
+    if failed:
+        return 1
+    print(f"No stage regressed more than {args.threshold:g}% against {args.baseline}")
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,193 @@
+#!/usr/bin/env python3
+#
+# BSD 3-Clause License
+#
+# Copyright (c) 2026, k4m1 <me@k4m1.net>
+# All rights reserved.
+#
+# See LICENSE in the root of this repository for full license text.
+#
+# Decode TinyBIOS binary log output back into text.
+#
+# With -Dbinary_log=ON level tagged blogf_X() calls emit compact records
+# that refer to their format strings by offset in the .blog_fmt section of
+# tinybios.elf, see src/include/console/binlog.h for record layout. Plain
+# text in the stream is passed through as is.
+#
+# Usage:
+#   blogdecode.py build/tinybios.elf serial.log
+#   qemu-system-x86_64 ... -debugcon stdio | blogdecode.py build/tinybios.elf
+#
+import argparse
+import re
+import struct
+import sys
+
+BLOG_BIN_MAGIC = 0xFF
+LEVELS = ["error", "warning", "info", "debug", "spew"]
+
+def elf_section(path, name):
+    """Return contents of ELF64 section by name."""
+    with open(path, "rb") as f:
+        elf = f.read()
+    if elf[:4] != b"\x7fELF" or elf[4] != 2:
+        raise SystemExit(f"{path}: not an ELF64 file")
+    shoff, = struct.unpack_from("<Q", elf, 0x28)
+    shentsize, shnum, shstrndx = struct.unpack_from("<HHH", elf, 0x3A)
+
+    def shdr(i):
+        return struct.unpack_from("<IIQQQQIIQQ", elf, shoff + (i * shentsize))
+
+    strtab = shdr(shstrndx)
+    for i in range(shnum):
+        sh = shdr(i)
+        off = strtab[4] + sh[0]
+        sname = elf[off:elf.index(b"\0", off)].decode()
+        if sname == name:
+            return elf[sh[4]:sh[4] + sh[5]]
+    raise SystemExit(f"{path}: no {name} section, was it built with binary_log?")
+
+class Stream:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def byte(self):
+        if self.pos >= len(self.data):
+            raise EOFError
+        b = self.data[self.pos]
+        self.pos += 1
+        return b
+
+    def uleb(self):
+        ret = 0
+        shift = 0
+        while True:
+            b = self.byte()
+            ret |= (b & 0x7F) << shift
+            shift += 7
+            if not (b & 0x80):
+                return ret
+
+    def cstr(self):
+        end = self.data.find(b"\0", self.pos)
+        if end < 0:
+            raise EOFError
+        s = self.data[self.pos:end]
+        self.pos = end + 1
+        return s.decode(errors="replace")
+
+# Same conversions console.c takes: %[-][0][width|*][hh|h|l|ll|z]conv.
+# Precision isn't supported there either, such specs are printed as is
+# on target and don't match here.
+SPEC = re.compile(r"%([-0]*)(\*|\d*)(ll|l|hh|h|z|)([diuxXpcs%])")
+
+# Numbers are padded to at most this wide, see BLOGF_MAX_WIDTH
+MAX_WIDTH = 64
+
+def format_record(fmt, args):
+    """Format args the way console.c would have."""
+    it = iter(args)
+
+    def conv(m):
+        flags, width, length, kind = m.groups()
+        left = "-" in flags
+        zero = "0" in flags
+        if width == "*":
+            width = next(it, 0)
+            if not isinstance(width, int):
+                width = 0
+            width &= 0xFFFFFFFF
+            if width >> 31:
+                left = True
+                width = (1 << 32) - width
+        else:
+            width = int(width) if width else 0
+        if kind == "%":
+            return "%"
+        val = next(it, 0)
+        if kind == "s":
+            s = val if isinstance(val, str) else f"<0x{val:x}>"
+            return s.ljust(width) if left else s.rjust(width)
+        if kind == "c":
+            s = chr(val & 0xFF)
+            return s.ljust(width) if left else s.rjust(width)
+        if isinstance(val, str):
+            val = 0
+        if kind == "p":
+            bits = 64
+            width, zero, left = 18, True, False
+        else:
+            bits = {"l": 64, "ll": 64, "z": 64, "h": 16, "hh": 8}.get(length, 32)
+        val &= (1 << bits) - 1
+        sign = ""
+        if kind in "di" and val >> (bits - 1):
+            sign = "-"
+            val = (1 << bits) - val
+        if kind == "x":
+            digits = f"{val:x}"
+        elif kind == "X":
+            digits = f"{val:X}"
+        elif kind == "p":
+            digits = f"{val:x}"
+        else:
+            digits = str(val)
+        width = min(width, MAX_WIDTH)
+        prefix = sign + ("0x" if kind == "p" else "")
+        if zero and not left:
+            digits = digits.rjust(width - len(prefix), "0")
+        s = prefix + digits
+        return s.ljust(width) if left else s.rjust(width)
+
+    return SPEC.sub(conv, fmt)
+
+def fmt_string(table, off):
+    end = table.find(b"\0", off)
+    if off >= len(table) or end < 0:
+        return f"<bad format id 0x{off:x}>\n"
+    return table[off:end].decode(errors="replace")
+
+def decode(table, data, out, show_levels):
+    s = Stream(data)
+    text_start = 0
+    while s.pos < len(data):
+        if data[s.pos] != BLOG_BIN_MAGIC:
+            s.pos += 1
+            continue
+        out.write(data[text_start:s.pos].decode(errors="replace"))
+        rec_start = s.pos
+        try:
+            s.byte()
+            level = s.byte()
+            fmt = fmt_string(table, s.uleb())
+            argc = s.uleb()
+            strmask = s.uleb()
+            args = []
+            for i in range(argc):
+                args.append(s.cstr() if (strmask >> i) & 1 else s.uleb())
+        except EOFError:
+            out.write(f"<truncated record at 0x{rec_start:x}>\n")
+            return
+        if show_levels and level < len(LEVELS):
+            out.write(f"[{LEVELS[level]}] ")
+        out.write(format_record(fmt, args))
+        text_start = s.pos
+    out.write(data[text_start:].decode(errors="replace"))
+
+def main():
+    ap = argparse.ArgumentParser(description="Decode TinyBIOS binary log")
+    ap.add_argument("elf", help="tinybios.elf the log came from")
+    ap.add_argument("log", nargs="?", help="captured log, stdin if omitted")
+    ap.add_argument("--levels", action="store_true", help="prefix records with their level")
+    args = ap.parse_args()
+
+    table = elf_section(args.elf, ".blog_fmt")
+    if args.log:
+        with open(args.log, "rb") as f:
+            data = f.read()
+    else:
+        data = sys.stdin.buffer.read()
+    decode(table, data, sys.stdout, args.levels)
+
+if __name__ == "__main__":
+    main()
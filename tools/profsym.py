@@ -0,0 +1,111 @@
+#!/usr/bin/env python3
+#
+# BSD 3-Clause License
+#
+# Copyright (c) 2026, k4m1 <me@k4m1.net>
+# All rights reserved.
+#
+# See LICENSE in the root of this repository for full license text.
+#
+# Turn TinyBIOS profiler samples into a flat profile.
+#
+# With -Dprofile_hz=N the timer interrupt records the RIP it interrupted
+# N times a second, and end of POST dumps "profile <rip> <count>" lines,
+# see src/include/sys/profile.h. This looks up which function of
+# tinybios.elf each address falls in and prints samples per function.
+# Binary log output must be decoded with blogdecode.py first.
+#
+# Usage:
+#   profsym.py build/tinybios.elf serial.log
+#   qemu-system-x86_64 ... -debugcon stdio | profsym.py build/tinybios.elf
+#
+import argparse
+import bisect
+import re
+import struct
+import sys
+
+SAMPLE = re.compile(r"profile ([0-9a-fA-F]+) (\d+)\s*$")
+STT_FUNC = 2
+
+def elf_symbols(path):
+    """Return sorted list of (address, size, name) of ELF64 functions."""
+    with open(path, "rb") as f:
+        elf = f.read()
+    if elf[:4] != b"\x7fELF" or elf[4] != 2:
+        raise SystemExit(f"{path}: not an ELF64 file")
+    shoff, = struct.unpack_from("<Q", elf, 0x28)
+    shentsize, shnum, _ = struct.unpack_from("<HHH", elf, 0x3A)
+
+    def shdr(i):
+        return struct.unpack_from("<IIQQQQIIQQ", elf, shoff + (i * shentsize))
+
+    symbols = []
+    for i in range(shnum):
+        sh = shdr(i)
+        if sh[1] != 2:  # SHT_SYMTAB
+            continue
+        strtab = shdr(sh[6])
+        for off in range(sh[4], sh[4] + sh[5], sh[9]):
+            name, info, _, shndx, value, size = struct.unpack_from("<IBBHQQ", elf, off)
+            if (info & 0xF) != STT_FUNC or shndx == 0:
+                continue
+            start = strtab[4] + name
+            symbols.append((value, size, elf[start:elf.index(b"\0", start)].decode()))
+    if not symbols:
+        raise SystemExit(f"{path}: no function symbols, was it stripped?")
+    symbols.sort()
+    return symbols
+
+def symbolise(symbols, addrs, rip):
+    i = bisect.bisect_right(addrs, rip) - 1
+    if i < 0:
+        return None
+    value, size, name = symbols[i]
+    # Assembly labels often have no size, take them as running up to
+    # the next symbol
+    if size and rip >= value + size:
+        return None
+    return name
+
+def main():
+    ap = argparse.ArgumentParser(description="Symbolise TinyBIOS profiler samples")
+    ap.add_argument("elf", help="tinybios.elf the samples came from")
+    ap.add_argument("log", nargs="?", help="log file, stdin if not given")
+    ap.add_argument("--addresses", action="store_true",
+                    help="list individual addresses under each function")
+    args = ap.parse_args()
+
+    symbols = elf_symbols(args.elf)
+    addrs = [s[0] for s in symbols]
+
+    log = open(args.log, errors="replace") if args.log else sys.stdin
+    funcs = {}
+    total = 0
+    for line in log:
+        m = SAMPLE.search(line)
+        if not m:
+            continue
+        rip, hits = int(m.group(1), 16), int(m.group(2))
+        name = symbolise(symbols, addrs, rip) or "[unknown]"
+        hits_addr = funcs.setdefault(name, {})
+        hits_addr[rip] = hits_addr.get(rip, 0) + hits
+        total += hits
+    if total == 0:
+        raise SystemExit("no profiler samples found, was it built with profile_hz?")
+
+    rows = sorted(funcs.items(), key=lambda kv: sum(kv[1].values()), reverse=True)
+    print(f"{total} samples")
+    print(f"{'samples':>8} {'self%':>6} {'cum%':>6}  function")
+    cum = 0
+    for name, hits_addr in rows:
+        hits = sum(hits_addr.values())
+        cum += hits
+        print(f"{hits:8} {100.0 * hits / total:6.2f} {100.0 * cum / total:6.2f}  {name}")
+        if args.addresses:
+            for rip, n in sorted(hits_addr.items(), key=lambda kv: kv[1], reverse=True):
+                print(f"{n:8} {'':6} {'':6}    {rip:#x}")
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())